@@ -0,0 +1,112 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Streams positions through a set of solver threads. Each input line is a scramble in standard
+ * move notation or a 54-character facelet string, and each output line is the solution of the
+ * input line in the same place, or a line starting "error:".
+ *
+ * Lines are read into a fixed ring of slots that also serves as the reorder buffer: a slot is
+ * only reused once its result has been written, so reading never gets more than the size of the
+ * ring ahead of writing and memory use stays flat however long the input is.
+ *
+ * @author mdq3
+ */
+
+#ifndef BATCHSOLVER_H_
+#define BATCHSOLVER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "OptimalSolver.hpp"
+#include "SolutionCache.hpp"
+#include "TwoPhaseSolver.hpp"
+
+/**
+ *
+ */
+class BatchSolver {
+ public:
+    enum Method { TWO_PHASE, OPTIMAL };
+
+    /**
+     * Constructor for BatchSolver.
+     *
+     * @param method The solver to use
+     * @param threads The number of solver threads, or 0 for one per hardware thread
+     * @param window The number of lines that may be in flight at once
+     * @param maxLength The maximum solution length
+     * @param cache The cache the solver threads share, or nullptr for none
+     */
+    BatchSolver(Method method, int threads, int window, int maxLength, SolutionCache* cache = nullptr);
+
+    ~BatchSolver();
+
+    /**
+     * Solve every line of the input, writing the results to the output in input order.
+     *
+     * @return the number of lines solved
+     */
+    uint64_t run(std::istream& input, std::ostream& output);
+
+    int getThreadCount() const;
+
+    /**
+     * Get the number of lines read by the last run.
+     */
+    uint64_t getLineCount() const;
+
+ private:
+    struct Slot
+    {
+        std::string line;
+        std::string result;
+        bool done;
+    };
+
+    Method method;
+    int threads;
+    int maxLength;
+    SolutionCache* cache;
+    std::vector<Slot> slots;     // Ring of lines in flight, indexed by line number
+    std::deque<uint64_t> queue;  // Lines waiting for a solver thread
+    uint64_t read;               // Lines read so far
+    uint64_t written;            // Lines written so far
+    uint64_t solved;
+    bool endOfInput;
+    std::mutex mutex;
+    std::condition_variable slotFree;
+    std::condition_variable lineQueued;
+    std::condition_variable resultReady;
+
+    void work();
+
+    void write(std::ostream& output);
+
+    std::string solveLine(const std::string& line, TwoPhaseSolver* twoPhase, OptimalSolver* optimal,
+                          bool& success);
+};
+
+#endif // BATCHSOLVER_H_
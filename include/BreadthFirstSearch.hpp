@@ -0,0 +1,128 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Breadth-first enumeration of a group of cube states described by coordinates, counting the
+ * states at each distance from solved. A state is the combination of the coordinate values, and
+ * the moves act on each coordinate through its move table.
+ *
+ * Each state takes 2 bits: its distance modulo 3, or 3 if not reached yet. The neighbours of a
+ * state are at most one level nearer or further away, so that is enough to tell the frontier
+ * from the levels before and after it. Early levels expand the frontier forwards; once the
+ * frontier outnumbers the states not yet reached, each of those looks for a neighbour on the
+ * frontier instead. Both are split into chunks run on a work-stealing pool, with the 2-bit
+ * entries updated by atomic operations on 64-bit words.
+ *
+ * @author mdq3
+ */
+
+#ifndef BREADTHFIRSTSEARCH_H_
+#define BREADTHFIRSTSEARCH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "CubeState.hpp"
+#include "WorkStealingPool.hpp"
+
+/**
+ *
+ */
+class BreadthFirstSearch {
+ public:
+    /**
+     * A coordinate of the states searched, as used by Coordinates.
+     */
+    struct Coordinate
+    {
+        int size;
+        int (*get)(const CubeState&);
+        void (*set)(CubeState&, int);
+    };
+
+    /**
+     * Called after each level with the distance, the number of states at that distance and
+     * the seconds the level took.
+     */
+    typedef std::function<void(int depth, uint64_t count, double seconds)> Progress;
+
+    /**
+     * Constructor for BreadthFirstSearch. Builds the move tables of the coordinates.
+     *
+     * @param coordinates The coordinates, the first varying slowest in the state index
+     * @param moves The moves generating the group
+     * @param threads The number of threads, or 0 for one per hardware thread
+     */
+    BreadthFirstSearch(const std::vector<Coordinate>& coordinates, const std::vector<int>& moves, int threads);
+
+    ~BreadthFirstSearch();
+
+    /**
+     * Search from the solved state until every reachable state is found.
+     *
+     * @param progress Called after each level, may be empty
+     * @return the number of states at each distance
+     */
+    std::vector<uint64_t> run(const Progress& progress);
+
+    /**
+     * Get the number of combinations of coordinate values, reachable or not.
+     */
+    uint64_t getSize() const;
+
+    int getThreadCount() const;
+
+ private:
+    static const uint64_t CHUNK = 1 << 16; // States per task, a multiple of the 32 in a word
+    static const int MAX_COORDINATES = 4;
+
+    std::vector<Coordinate> coordinates;
+    std::vector<std::vector<uint16_t>> moveTables; // Per coordinate, [value * 18 + move]
+    std::vector<int> moves;
+    uint64_t size;
+    std::unique_ptr<std::atomic<uint64_t>[]> words; // 32 states per word
+    std::unique_ptr<WorkStealingPool> pool;
+
+    BreadthFirstSearch(const BreadthFirstSearch&) = delete;
+    BreadthFirstSearch& operator=(const BreadthFirstSearch&) = delete;
+
+    int get(uint64_t index) const;
+
+    /**
+     * Set a state that has not been reached to a value.
+     *
+     * @return true if this call reached it, false if another thread did first
+     */
+    bool reach(uint64_t index, int value);
+
+    /**
+     * Get the indices of the states one move away from a state.
+     *
+     * @return the number of neighbours
+     */
+    int neighbours(uint64_t index, uint64_t* next) const;
+
+    uint64_t expandForward(uint64_t begin, uint64_t end, int current, int next);
+
+    uint64_t expandBackward(uint64_t begin, uint64_t end, int current, int next);
+};
+
+#endif // BREADTHFIRSTSEARCH_H_
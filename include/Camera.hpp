@@ -18,7 +18,8 @@
 */
 
 /**
- * 3D camera.
+ * 3D camera. The view and projection-view matrices are cached, and recomputed only after the
+ * camera has moved, turned or changed projection.
  *
  * @author mdq3
  */
@@ -43,6 +44,12 @@ class Camera {
     glm::mat4 getProjectionViewMatrix();
     glm::vec3 getPosition();
 
+    /**
+     * Get the number of matrices computed so far, counting one per matrix: the view and the
+     * projection-view matrix each time the camera moves.
+     */
+    unsigned long getTransformUpdates() const;
+
     void setSpeedX(GLfloat speed);
     void setSpeedY(GLfloat speed);
     void setSpeedZ(GLfloat speed);
@@ -71,10 +78,19 @@ class Camera {
     glm::vec3 sideways;  // Right/Left direction
 
     glm::mat4 projectionMatrix;
+    glm::mat4 viewMatrix;           // Cached from the LookAt vectors
+    glm::mat4 projectionViewMatrix; // Cached from the projection and view matrices
+    bool viewChanged;               // Whether the cached matrices need recomputing
+    unsigned long transformUpdates; // Times they have been recomputed
 
     GLfloat currentSpeedX;
     GLfloat currentSpeedY;
     GLfloat currentSpeedZ;
+
+    /**
+     * Recompute the view and projection-view matrices if the camera has changed.
+     */
+    void updateMatrices();
 };
 
 #endif // CAMERA_H_
@@ -0,0 +1,110 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Coordinates of a CubeState: dense integer ranks of one aspect of the state (corner twist,
+ * edge flip, UD-slice edge positions, corner and edge permutations) used to index solver move
+ * and pruning tables. Every getter has a setter that writes the coordinate back into a state,
+ * used when building the tables.
+ *
+ * @author mdq3
+ */
+
+#ifndef COORDINATES_H_
+#define COORDINATES_H_
+
+#include <cstdint>
+#include <vector>
+#include "CubeState.hpp"
+
+/**
+ *
+ */
+class Coordinates {
+ public:
+    static const int N_TWIST        = 2187;  // 3^7 corner orientations
+    static const int N_FLIP         = 2048;  // 2^11 edge orientations
+    static const int N_SLICE        = 495;   // 12 choose 4 positions of the UD-slice edges
+    static const int N_SLICE_SORTED = 11880; // Positions and order of the UD-slice edges
+    static const int N_SLICE_PERM   = 24;    // Order of the UD-slice edges within the slice
+    static const int N_CORNER_PERM  = 40320; // 8! corner permutations
+    static const int N_UD_EDGE_PERM = 40320; // 8! permutations of the U and D layer edges
+    static const int N_FLIP_SLICE   = N_FLIP * N_SLICE;
+
+    static int getTwist(const CubeState& state);
+    static void setTwist(CubeState& state, int twist);
+
+    static int getFlip(const CubeState& state);
+    static void setFlip(CubeState& state, int flip);
+
+    /**
+     * Rank of the positions and order of the FR, FL, BL and BR edges. Divided by 24 it gives
+     * the phase 1 slice coordinate; in the phase 2 subgroup it is below 24 and gives the order
+     * of the edges within the slice.
+     */
+    static int getSliceSorted(const CubeState& state);
+
+    /**
+     * Set the edge permutation from a slice coordinate. The eight U and D layer edges fill the
+     * remaining positions in order.
+     */
+    static void setSliceSorted(CubeState& state, int sliceSorted);
+
+    /**
+     * The flip and the phase 1 slice coordinate together, slice * 2048 + flip. The U-D
+     * symmetries change the flip of an edge by where it is, so the flip is only conjugated
+     * correctly along with the slice.
+     */
+    static int getFlipSlice(const CubeState& state);
+    static void setFlipSlice(CubeState& state, int flipSlice);
+
+    static int getCornerPermutation(const CubeState& state);
+    static void setCornerPermutation(CubeState& state, int permutation);
+
+    /**
+     * Permutation of the eight U and D layer edges. Only meaningful when all of them are in the
+     * U and D layers, i.e. in the phase 2 subgroup.
+     */
+    static int getUDEdgePermutation(const CubeState& state);
+    static void setUDEdgePermutation(CubeState& state, int permutation);
+
+    /**
+     * Build a move table for a coordinate: entry [value * 18 + move] is the coordinate after
+     * the move. Entries for moves not listed are left 0.
+     *
+     * @param table The table to fill
+     * @param size The number of coordinate values
+     * @param get The coordinate getter
+     * @param set The coordinate setter
+     * @param moves The moves to tabulate
+     * @param moveCount The number of moves
+     */
+    static void buildMoveTable(std::vector<uint16_t>& table, int size, int (*get)(const CubeState&),
+                               void (*set)(CubeState&, int), const int* moves, int moveCount);
+
+    /**
+     * Rank of a permutation of n elements (0 to n! - 1).
+     */
+    static int rankPermutation(const int* permutation, int n);
+    static void unrankPermutation(int rank, int* permutation, int n);
+
+    static int binomial(int n, int k);
+};
+
+#endif // COORDINATES_H_
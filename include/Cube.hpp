@@ -18,7 +18,10 @@
 */
 
 /**
- * Representation of 3D rotating cube puzzle.
+ * Representation of 3D rotating cube puzzle of any size. The cubies on the surface are drawn as
+ * instances of one CubieMesh, each coloured from the stickers of an NxNCubeState. A turn is
+ * animated by rotating the instances in the turning layer; when it finishes the stickers are
+ * turned and the instances return to their places, recoloured.
  *
  * @author mdq3
  */
@@ -29,62 +32,165 @@
 #include <vector>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
-#include "Model.hpp"
-#include "Importer.hpp"
+#include "CubieMesh.hpp"
+#include "CubeState.hpp"
+#include "NxNCubeState.hpp"
 
 /**
  *
  */
 class Cube {
  public:
+    static const unsigned int MAX_QUEUED = 256; // Moves that can wait to be animated
+
     Cube();
 
     /**
      * Constructor for Cube.
+     *
+     * @param shaderProgram The program to render the cubies with
+     * @param size The number of layers
      */
-    Cube(GLuint shaderProgram);
+    Cube(GLuint shaderProgram, int size = 3);
 
     /**
      * Destructor for Cube. Release resources.
      */
     ~Cube();
 
-    void renderShadowMap(GLuint shadowProgram);
+    /**
+     * Render every cubie into the shadow map, with the cubie shadow program in use.
+     */
+    void renderShadowMap();
 
     /**
-     * Render every mesh in the cube.
-     *
-     * @param viewProjectionMatrix The VPM matrix rendering the cube
+     * Render every cubie in the cube, with its shader program in use.
      */
-    void render(glm::mat4 viewProjectionMatrix, glm::mat4 depthBiasMVP);
+    void render();
 
     /**
      * Execute transformation operations for current render cycle.
      */
     void operations();
 
-    void rotateFront(GLfloat angle, bool clockwise);
-    void rotateBack(GLfloat angle, bool clockwise);
-    void rotateLeft(GLfloat angle, bool clockwise);
-    void rotateRight(GLfloat angle, bool clockwise);
-    void rotateTop(GLfloat angle, bool clockwise);
-    void rotateBottom(GLfloat angle, bool clockwise);
+    /**
+     * Queue a quarter turn of a face, to be animated after any turns already waiting.
+     *
+     * @param clockwise The direction, as seen from the face
+     */
+    void rotateFront(bool clockwise);
+    void rotateBack(bool clockwise);
+    void rotateLeft(bool clockwise);
+    void rotateRight(bool clockwise);
+    void rotateTop(bool clockwise);
+    void rotateBottom(bool clockwise);
+
+    /**
+     * Queue a sequence of moves to be animated one after another. The queue is put in
+     * canonical form first, so turns that cancel out are never animated and R R R plays as R'.
+     * The more moves are waiting, the faster each is animated.
+     *
+     * @param moves The CubeState move indices, turning the outer layers
+     * @return false, queuing none of the moves, if they would not fit in the queue
+     */
+    bool play(const std::vector<int>& moves);
+
+    /**
+     * Get the puzzle state of the outer layers, including a turn being animated. Only a 3x3x3
+     * cube is fully described by it.
+     */
+    const CubeState& getState() const;
+
+    /**
+     * Get the state of the outer layers once every queued move has been animated.
+     */
+    CubeState getFinalState() const;
+
+    /**
+     * Set the puzzle to a state, dropping the queued moves and any turn being animated. Only a
+     * 3x3x3 cube can be set.
+     *
+     * @param state A solvable state
+     * @return false if the cube is not 3x3x3
+     */
+    bool setState(const CubeState& state);
+
+    int getSize() const;
+
+    /**
+     * Get the number of matrices computed so far, counting one per matrix: the rotation of each
+     * frame of a turn and the transform of each cubie it moves.
+     */
+    unsigned long getTransformUpdates() const;
+
+    /**
+     * Get the number of times the cubies have been put in place, to tell whether a shadow map
+     * drawn of them is out of date.
+     */
+    unsigned long getPlacementCount() const;
 
  private:
-    std::vector<Model> cubes; // Cube models which make up the whole cube puzzle
+    /**
+     * A cubie on the surface of the puzzle.
+     */
+    struct Slot
+    {
+        int layer[3];        // Layer along the x, y and z axes, 0 at the left, bottom and back
+        glm::mat4 transform; // Translation to the centre of the cubie in model space
+    };
 
-    // Indices for each cube for each face in cubes
-    std::vector<int> frontFace  = {6, 7, 3, 2, 12, 11, 9, 10, 22};
-    std::vector<int> backFace   = {5, 4, 0, 1, 17, 13, 8, 15, 20};
-    std::vector<int> leftFace   = {4, 6, 2, 0, 18, 10, 14, 13, 23};
-    std::vector<int> rightFace  = {7, 5, 1, 3, 19, 15, 16, 11, 24};
-    std::vector<int> topFace    = {4, 5, 7, 6, 17, 19, 12, 18, 25};
-    std::vector<int> bottomFace = {2, 3, 1, 0, 9, 16, 8, 14, 21};
+    /**
+     * A layer turn being animated.
+     */
+    struct Turn
+    {
+        int face;
+        int layer;
+        int turns;
+        int frame;  // Frames of the turn animated so far, 0 when none is
+        int frames; // Frames the turn is animated over
+    };
+
+    GLuint shaderProgram;
+    GLint shininessLocation; // Location of the material shininess uniform
+    int size;
+    CubieMesh mesh;
+    NxNCubeState stickers;                     // Stickers shown when no turn is animated
+    CubeState state;                           // Cubie-level state of the outer layers
+    std::vector<Slot> slots;                   // Every cubie on the surface, one per instance
+    std::vector<CubieMesh::Instance> instances; // Transforms and colours of the cubies
+    std::vector<int> queue;                    // Moves waiting to be animated, in canonical form
+    Turn current;                              // The turn being animated
+    bool instancesChanged;                     // Whether the instances need uploading
+    unsigned long transformUpdates;            // Cubie transforms computed so far
+    unsigned long placements;                  // Times the instances have been placed
 
     /**
+     * Start the animation of a face turn and apply the turn to the puzzle state.
      *
+     * @param move The CubeState move index
      */
-    void rotate(GLfloat angle, glm::vec3 axis, std::vector<int> face, bool clockwise);
+    void turn(int move);
+
+    /**
+     * Start the animation of a turn of any layer, quicker the more moves are queued behind it.
+     */
+    void turnLayer(int face, int layer, int turns);
+
+    bool isRotating();
+
+    /**
+     * Set the colours of every instance from the stickers.
+     */
+    void colourInstances();
+
+    /**
+     * Set the transforms of the instances: in place, or rotated part way for the turning layer.
+     * Only the turning layer's are computed; the rest are copied from their slots.
+     */
+    void placeInstances();
+
+    bool isInTurn(const Slot& slot) const;
 };
 
-#endif // CUBE_H_
\ No newline at end of file
+#endif // CUBE_H_
@@ -0,0 +1,168 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Cubie-level state of the cube puzzle. Corner and edge permutation and orientation are packed
+ * into two 64-bit words, one 5-bit field per position, and face turns are applied from
+ * precomputed move tables. Independent of OpenGL so it can be used headless.
+ *
+ * Corners are numbered URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB and edges UR, UF, UL, UB, DR,
+ * DF, DL, DB, FR, FL, BL, BR. Moves are numbered face * 3 + (quarter turns - 1) with faces in
+ * the order U, R, F, D, L, B, so move 0 is U, 1 is U2, 2 is U' and so on.
+ *
+ * @author mdq3
+ */
+
+#ifndef CUBESTATE_H_
+#define CUBESTATE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *
+ */
+class CubeState {
+ public:
+    enum Face { U, R, F, D, L, B };
+
+    static const int N_CORNERS = 8;
+    static const int N_EDGES   = 12;
+    static const int N_FACES   = 6;
+    static const int N_MOVES   = 18;
+
+    /**
+     * Constructor for CubeState. Creates the solved state.
+     */
+    CubeState();
+
+    /**
+     * Apply a single face turn.
+     *
+     * @param move The move index (face * 3 + quarter turns - 1)
+     */
+    void apply(int move);
+
+    /**
+     * Apply a sequence of face turns in order.
+     */
+    void apply(const std::vector<int>& moves);
+
+    int cornerPermutation(int position) const;
+    int cornerOrientation(int position) const;
+    int edgePermutation(int position) const;
+    int edgeOrientation(int position) const;
+
+    /**
+     * Place a corner cubie at a position with the given twist (0-2).
+     */
+    void setCorner(int position, int cubie, int orientation);
+
+    /**
+     * Place an edge cubie at a position with the given flip (0-1).
+     */
+    void setEdge(int position, int cubie, int orientation);
+
+    bool isSolved() const;
+
+    /**
+     * Check that the state can be reached from the solved state by face turns: every cubie is
+     * present once, the corner twists sum to a multiple of 3, the edge flips sum to an even
+     * number and the corner and edge permutations have the same parity.
+     */
+    bool isSolvable() const;
+
+    /**
+     * Get the inverse state, the one that a solution of this state turns the solved cube into.
+     */
+    CubeState inverse() const;
+
+    uint64_t getCornerWord() const;
+    uint64_t getEdgeWord() const;
+
+    /**
+     * Set the whole state from words packed as getCornerWord and getEdgeWord return them.
+     */
+    void setWords(uint64_t cornerWord, uint64_t edgeWord);
+
+    bool operator==(const CubeState& other) const;
+    bool operator!=(const CubeState& other) const;
+
+    /**
+     * Index, in the 26-cubie layout used by Cube and cub3.q3d, of the cubie currently
+     * occupying a slot of that layout. Centre slots (20-25) never move.
+     *
+     * @param slot The slot index in the 26-cubie layout
+     * @return the layout index of the cubie in the slot
+     */
+    int cubieAt(int slot) const;
+
+    static int cornerSlot(int corner);
+    static int edgeSlot(int edge);
+
+    static int moveIndex(int face, int quarterTurns);
+    static int moveFace(int move);
+    static int movePower(int move);
+    static int inverseMove(int move);
+
+    /**
+     * Get the moves that may follow a move in a canonical sequence: never the same face again,
+     * and of two opposite faces, which commute, only U before D, R before L and F before B.
+     * Searches generate only these, which skips branches that repeat a state reached by
+     * another one.
+     *
+     * @param previous The previous move, or -1 at the start of a sequence
+     * @return a mask with bit m set if move m may follow
+     */
+    static uint32_t followingMoves(int previous);
+
+    /**
+     * Rewrite a sequence of moves in canonical form, turning the same state: turns of the same
+     * face are merged (R R' cancels, R R R becomes R'), also across a turn of the opposite face,
+     * and pairs of opposite faces are put in the order followingMoves allows.
+     */
+    static void canonicalize(std::vector<int>& moves);
+
+    /**
+     * Get the standard notation for a move, e.g. "R", "U2" or "F'".
+     */
+    static std::string moveName(int move);
+
+    /**
+     * Parse a sequence of moves in standard notation, e.g. "R U2 F'". Spaces between moves are
+     * optional.
+     *
+     * @param text The moves to parse
+     * @param moves Set to the move indices
+     * @return false if the text is not a sequence of moves
+     */
+    static bool parseMoves(const std::string& text, std::vector<int>& moves);
+
+    /**
+     * Get the standard notation for a sequence of moves, separated by spaces.
+     */
+    static std::string formatMoves(const std::vector<int>& moves);
+
+ private:
+    uint64_t corners; // 8 x 5 bits: cubie (3 bits) | twist << 3
+    uint64_t edges;   // 12 x 5 bits: cubie (4 bits) | flip << 4
+};
+
+#endif // CUBESTATE_H_
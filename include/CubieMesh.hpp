@@ -0,0 +1,106 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * Procedurally generated cubie, drawn once per cubie of a puzzle in a single instanced draw
+ * call. The mesh is a cube with bevelled edges and corners; each vertex records which face of
+ * the cubie it belongs to, or PLASTIC for the bevels. Each instance has its own transform and
+ * the colours of its six faces, packed into one integer.
+ *
+ * Vertex attributes are at fixed locations: position 0, normal 1, face 2, and per instance the
+ * columns of the transform 3 to 6 and the colours 7. The vertices are welded, interleaved in one
+ * buffer and drawn through an index buffer ordered for the vertex cache. The attributes are
+ * captured in a vertex array object, with a second one of positions and transforms only for
+ * the shadow map, so a draw binds nothing else.
+ *
+ * @author mdq3
+ */
+
+#ifndef CUBIEMESH_H_
+#define CUBIEMESH_H_
+
+#include <vector>
+#include <GL/glew.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+/**
+ *
+ */
+class CubieMesh {
+ public:
+    static const GLuint PLASTIC     = 6; // Face index of the bevels, and colour of hidden faces
+    static const int    COLOUR_BITS = 3; // Bits per face in Instance::colours
+
+    /**
+     * Per-instance data, as laid out in the instance buffer.
+     */
+    struct Instance
+    {
+        glm::mat4 transform; // Model transform of the cubie
+        GLuint colours;      // Colour of each face, in CubeState face order from the low bits
+    };
+
+    CubieMesh();
+
+    /**
+     * Constructor for CubieMesh. Generates the mesh and uploads it.
+     *
+     * @param size The side of the cubie
+     * @param bevel The width of the bevels, as a fraction of the side
+     */
+    CubieMesh(GLfloat size, GLfloat bevel);
+
+    ~CubieMesh();
+
+    /**
+     * Upload the instances to draw, growing the instance buffer if needed.
+     */
+    void setInstances(const std::vector<Instance>& instances);
+
+    /**
+     * Draw every instance with positions and transforms only.
+     */
+    void renderShadowMap();
+
+    /**
+     * Draw every instance.
+     */
+    void render();
+
+ private:
+    GLuint VBOvertex;         // Interleaved positions, normals and faces of one cubie
+    GLuint EBO;               // Indices of the triangles of one cubie
+    GLuint VBOinstance;       // Instance transforms and colours
+    GLuint VAO;               // All the attributes
+    GLuint shadowVAO;         // Positions and transforms only
+    GLuint indexCount;        // The number of indices in one cubie
+    GLuint instanceCount;     // The number of instances uploaded
+    GLuint instanceCapacity;  // The number of instances the instance buffer has room for
+
+    /**
+     * Capture the attributes of the vertex and instance buffers in a new vertex array object.
+     *
+     * @param shadow Whether to leave out the normals, faces and colours
+     */
+    GLuint createVertexArray(bool shadow);
+};
+
+#endif // CUBIEMESH_H_
@@ -0,0 +1,64 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Conversion between 54-character facelet strings and cube states. The facelets are listed face by
+ * face in the order U, R, F, D, L, B, each face read row by row as seen from outside the cube
+ * with U above F, and F, R, B, L above D. Any six characters may be used for the colours; each
+ * is taken to mean the face whose centre has that colour, so "UUUUUUUUURRR..." and
+ * "WWWWWWWWWRRR..." are read the same way.
+ *
+ * @author mdq3
+ */
+
+#ifndef FACELETS_H_
+#define FACELETS_H_
+
+#include <string>
+#include "CubeState.hpp"
+
+/**
+ *
+ */
+class Facelets {
+ public:
+    static const int N_FACELETS = 54;
+
+    /**
+     * Read a facelet string into a cube state. Each corner and edge is looked up in a table by
+     * its colours, without branching per facelet, so strings can be screened at millions per
+     * second. Whether the cubies make a reachable state is left to CubeState::isSolvable.
+     *
+     * @param facelets The 54 facelet colours
+     * @param state Set to the state the facelets describe
+     * @return false if the string is not 54 characters of six centre colours, or a corner or
+     *         edge has a combination of colours that no cubie has
+     */
+    static bool toState(const std::string& facelets, CubeState& state);
+
+    /**
+     * Get the facelet string of a cube state, with the colours named after their faces
+     * ("UUUUUUUUURRR..." for the solved state). Reading it back gives the same state.
+     *
+     * @param state A solvable state
+     */
+    static std::string fromState(const CubeState& state);
+};
+
+#endif // FACELETS_H_
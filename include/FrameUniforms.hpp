@@ -0,0 +1,89 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * Uniform data shared by every shader program and changing at most once per frame: camera,
+ * light and shadow transforms. It is kept in one std140 uniform buffer bound to a fixed
+ * binding point, declared once for all shaders in resources/shaders/frame.glsl, so each frame
+ * costs a single upload instead of a lookup and a call per uniform per program, and nothing
+ * at all when the frame is the same as the last.
+ *
+ * @author mdq3
+ */
+
+#ifndef FRAMEUNIFORMS_H_
+#define FRAMEUNIFORMS_H_
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/**
+ *
+ */
+class FrameUniforms {
+ public:
+    static const GLuint BINDING = 0; // Uniform buffer binding point of the Frame block
+
+    /**
+     * The Frame block, member for member in std140 layout.
+     */
+    struct Block
+    {
+        glm::mat4 viewProjectionMatrix;       // Camera
+        glm::mat4 shadowViewProjectionMatrix; // Light space, for rendering the shadow map
+        glm::mat4 depthBiasMVP;               // Light space to shadow map coordinates
+        glm::vec3 lightPosition;              // Light, a struct aligned to 16 bytes
+        GLfloat padding0;
+        glm::vec3 lightRGB;
+        GLfloat lightAttenuation;
+        glm::vec3 lightDirection;
+        GLint lightIsPoint;
+        GLfloat ambientLight;
+        GLfloat padding1[3];
+        glm::vec3 cameraPosition;
+        GLfloat padding2;
+    };
+
+    FrameUniforms();
+
+    ~FrameUniforms();
+
+    /**
+     * Create the uniform buffer and bind it to the binding point. Needs a GL context.
+     */
+    void init();
+
+    /**
+     * Connect a linked shader program's Frame block, if it has one, to the buffer.
+     */
+    void bindProgram(GLuint shaderProgram);
+
+    /**
+     * Set the data for this frame, uploading it only if it differs from the last frame's.
+     */
+    void update(const Block& block);
+
+ private:
+    GLuint UBO;    // The uniform buffer
+    Block current; // The data in the buffer
+    bool uploaded; // Whether the buffer holds any data yet
+};
+
+#endif // FRAMEUNIFORMS_H_
@@ -19,7 +19,9 @@
 
 /**
  * Importer for q3d file format. Parses the XML and stores the data in a structure for
- * generation of 3D graphics.
+ * generation of 3D graphics. The exporter writes each mesh as a list of triangles, three
+ * vertices apiece; they are welded into an indexed mesh ordered for the vertex cache by
+ * MeshOptimizer.
  *
  * @author mdq3
  */
@@ -27,6 +29,7 @@
 #ifndef IMPORTER_H_
 #define IMPORTER_H_
 
+#include <string>
 #include <vector>
 #include <glm/glm.hpp>
 #include <tinyxml2.h>
@@ -38,22 +41,40 @@ class Importer {
  public:
     struct Mesh
     {
-        std::vector<glm::vec3> vs;  // Vertices
-        std::vector<glm::vec3> ns;  // Normals
-        std::vector<glm::vec2> uvs; // UV coords
-        std::string texturePath;    // Path to texture image
-        int vsSize;                 // Number of vertices in mesh
+        std::string name;                  // Id of the object the mesh belongs to
+        std::vector<glm::vec3> vs;         // Vertices
+        std::vector<glm::vec3> ns;         // Normals
+        std::vector<glm::vec2> uvs;        // UV coords
+        std::vector<unsigned int> indices; // Three vertices per triangle
+        std::string texturePath;           // Path to texture image
+        int vsSize;                        // Number of vertices in mesh
     };
 
-    Importer(std::string fileName);
+    /**
+     * Constructor for Importer. Load every mesh in a q3d file.
+     *
+     * @param indexed Whether to weld and optimize the meshes, or keep the triangles as exported
+     */
+    Importer(std::string fileName, bool indexed = true);
 
     ~Importer();
 
     std::vector<Mesh> getObjects();
 
+    /**
+     * Merge the identical vertices of a mesh, keeping its triangles in order.
+     */
+    static void weld(Mesh& mesh);
+
+    /**
+     * Reorder the triangles and vertices of a welded mesh for the vertex cache and fetch.
+     */
+    static void optimize(Mesh& mesh);
+
  private:
     tinyxml2::XMLDocument doc;
     std::vector<Mesh> objects;
+    bool indexed;
 
     void loadXML(std::string fileName);
 
@@ -0,0 +1,92 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * Bounded lock-free queue between exactly one producer thread and one consumer thread. Messages
+ * are copied into a ring of slots. The producer owns the tail index and the consumer the head,
+ * each only reading the other's, so neither ever waits for the other. The indices are on
+ * separate cache lines so the two threads do not contend for one.
+ *
+ * @author mdq3
+ */
+
+#ifndef MAILBOX_H_
+#define MAILBOX_H_
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ *
+ */
+template <typename T, size_t Capacity>
+class Mailbox {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+ public:
+    Mailbox() :
+    head{0},
+    tail{0}
+    {}
+
+    /**
+     * Add a message. Only call from the producer thread.
+     *
+     * @return false, dropping the message, if the mailbox is full
+     */
+    bool post(const T& message)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(t - head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        slots[t & (Capacity - 1)] = message;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take the oldest message. Only call from the consumer thread.
+     *
+     * @return false if the mailbox is empty
+     */
+    bool poll(T& message)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        message = slots[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+ private:
+    T slots[Capacity];
+    alignas(64) std::atomic<size_t> head; // Next slot to read, written by the consumer
+    alignas(64) std::atomic<size_t> tail; // Next slot to write, written by the producer
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+};
+
+#endif // MAILBOX_H_
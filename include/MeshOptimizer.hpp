@@ -0,0 +1,128 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * Turns the flat triangle lists the q3d exporter and CubieMesh produce into indexed meshes
+ * ready for glDrawElements: identical vertices are welded into one, the triangles are reordered
+ * for the GPU's post-transform vertex cache with Tom Forsyth's linear-speed algorithm, and the
+ * vertices are renumbered in the order the triangles first use them, for locality of fetch.
+ *
+ * Vertices are compared byte for byte, so a vertex type must have no padding.
+ *
+ * @author mdq3
+ */
+
+#ifndef MESHOPTIMIZER_H_
+#define MESHOPTIMIZER_H_
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/**
+ *
+ */
+class MeshOptimizer {
+ public:
+    static const unsigned int CACHE_SIZE = 32; // Vertices in the modelled post-transform cache
+
+    /**
+     * Weld identical vertices of a triangle list.
+     *
+     * @param triangles Three vertices per triangle
+     * @param vertices Set to the distinct vertices, in the order they first appear
+     * @return three indices into the vertices per triangle
+     */
+    template <typename Vertex>
+    static std::vector<unsigned int> weld(const std::vector<Vertex>& triangles, std::vector<Vertex>& vertices)
+    {
+        std::vector<unsigned int> order(triangles.size());
+        for(unsigned int i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        // Equal vertices sort next to each other, the first of each run being the first to appear
+        std::stable_sort(order.begin(), order.end(), [&triangles](unsigned int a, unsigned int b)
+        {
+            return memcmp(&triangles[a], &triangles[b], sizeof(Vertex)) < 0;
+        });
+
+        std::vector<unsigned int> indices(triangles.size());
+        for(unsigned int i = 0; i < order.size(); ++i)
+        {
+            bool same = i > 0 && memcmp(&triangles[order[i]], &triangles[order[i - 1]], sizeof(Vertex)) == 0;
+            indices[order[i]] = same ? indices[order[i - 1]] : order[i];
+        }
+        vertices.clear();
+        std::vector<unsigned int> welded(triangles.size());
+        for(unsigned int i = 0; i < indices.size(); ++i)
+        {
+            if(indices[i] == i)
+            {
+                welded[i] = vertices.size();
+                vertices.push_back(triangles[i]);
+            }
+            indices[i] = welded[indices[i]];
+        }
+        return indices;
+    }
+
+    /**
+     * Reorder the triangles of an indexed mesh so vertices are reused while still in the cache.
+     *
+     * @param indices Three per triangle, reordered in place
+     * @param vertexCount The number of vertices the indices refer to
+     */
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+
+    /**
+     * Renumber the vertices in the order the triangles first use them, dropping any unused.
+     *
+     * @param indices Three per triangle, renumbered in place
+     * @param vertices Reordered in place
+     */
+    template <typename Vertex>
+    static void optimizeVertexFetch(std::vector<unsigned int>& indices, std::vector<Vertex>& vertices)
+    {
+        const unsigned int UNUSED = ~0u;
+        std::vector<unsigned int> renumbered(vertices.size(), UNUSED);
+        std::vector<Vertex> reordered;
+        reordered.reserve(vertices.size());
+        for(unsigned int& index : indices)
+        {
+            if(renumbered[index] == UNUSED)
+            {
+                renumbered[index] = reordered.size();
+                reordered.push_back(vertices[index]);
+            }
+            index = renumbered[index];
+        }
+        vertices.swap(reordered);
+    }
+
+    /**
+     * Average cache miss ratio: the vertices transformed per triangle drawn, with a FIFO cache
+     * as most hardware has. 3 for a triangle list with no reuse, approaching 0.5 for a large
+     * regular grid.
+     */
+    static double acmr(const std::vector<unsigned int>& indices, unsigned int cacheSize = CACHE_SIZE);
+};
+
+#endif // MESHOPTIMIZER_H_
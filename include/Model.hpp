@@ -19,7 +19,11 @@
 
 /**
  * 3D model. Holds geometry data and other attributes. Provides various transforms and sherical
- * linear interpolation for rotation.
+ * linear interpolation for rotation. The vertices are interleaved in one buffer and drawn
+ * through an index buffer, with their attributes captured in a vertex array object at load
+ * time. The model matrix, its normal matrix and the model-view-projection matrix are cached,
+ * and recomputed only when the model is moved or the camera's matrix changes. The texture is a
+ * layer of the scene's TextureArray, selected by the third texture coordinate of every vertex.
  *
  * @author mdq3
  */
@@ -46,9 +50,12 @@ class Model {
 
     /**
      * Constructor for Model.
+     *
+     * @param indices Three vertices per triangle
+     * @param textureLayer The layer of the bound TextureArray holding this model's texture
      */
     Model(std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& normals, std::vector<glm::vec2>& uvs,
-          std::string texturePath, GLuint vCount, GLuint shader, GLfloat shininess, bool dynamicDraw);
+          std::vector<GLuint>& indices, GLfloat textureLayer, GLuint shader, GLfloat shininess, bool dynamicDraw);
 
     /**
      * Destructor for Model. Release resources.
@@ -63,21 +70,31 @@ class Model {
 
     void worldRotate(GLfloat angle, glm::vec3 axis, GLfloat slerp);
 
-    void renderShadowMap(GLuint shadowProgram);
-
-    void render(glm::mat4 viewProjectionMatrix, glm::mat4 depthBiasMVP);
+    void render(glm::mat4 viewProjectionMatrix);
 
     void operations();
 
     bool isRotating();
 
+    /**
+     * Get the number of matrices computed so far, counting one per matrix: the model and normal
+     * matrices when the model moves, and the model-view-projection matrix when it or the camera
+     * moves.
+     */
+    unsigned long getTransformUpdates() const;
+
  private:
-    GLuint VBOposition;      // Vertex Buffer Object for vertex positions
-    GLuint VBOnormal;        // The vertex normals for this model
-    GLuint VBOuv;            // The UV coordinates for this model's texture
-    GLuint texture;          // This model's texture
+    GLuint VBOvertex;        // Interleaved vertex positions, normals and UV coordinates
+    GLuint EBO;              // Element buffer of the vertex indices
+    GLuint VAO;              // Vertex array object drawing the model
     GLuint shaderProgram;    // This model's shader program
-    GLuint vertexCount;      // The number of vertices in this model
+    GLuint indexCount;       // The number of indices in this model
+
+    // Uniform locations in the shader program, looked up once
+    GLint mvpMatrixLocation;
+    GLint modelMatrixLocation;
+    GLint normalMatrixLocation;
+    GLint shininessLocation;
 
     // Material Properties
     GLfloat materialShininess;
@@ -88,6 +105,12 @@ class Model {
     glm::mat4 modelWorldRotateMatrix; // The model's world rotation matrix
     glm::mat4 modelLocalRotateMatrix; // The model's local rotation matrix
 
+    glm::mat3 normalMatrix;              // Cached with the model matrix
+    glm::mat4 lastViewProjectionMatrix;  // The camera matrix the last render was given
+    glm::mat4 modelViewProjectionMatrix; // Cached for it
+    bool transformChanged;               // Whether the model matrix needs recomputing
+    unsigned long transformUpdates;      // Matrices recomputed so far
+
     glm::mat4 currentModelWorldRotateMatrix;
 
     GLfloat slerpRate;
@@ -95,16 +118,25 @@ class Model {
     GLfloat currentRotationAngle;
     glm::vec3 currentRotationAxis;
 
-    void createVBO(GLuint& VBO, std::vector<glm::vec3> data, GLenum usage);
-
-    void createUVBuffer(GLuint& VBOuv, std::vector<glm::vec2> data, GLenum usage);
-
-    void createTexture(std::string filePath);
+    /**
+     * Interleave the vertex data into the vertex buffer, upload the indices and create the vertex
+     * array object.
+     */
+    void createVertexArrays(std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& normals,
+                            std::vector<glm::vec2>& uvs, std::vector<GLuint>& indices,
+                            GLfloat textureLayer, GLenum usage);
 
-    void generateVertexNormals(std::vector<glm::vec3> vertices, std::vector<GLuint> indices, GLenum usage);
+    std::vector<glm::vec3> generateVertexNormals(std::vector<glm::vec3> vertices, std::vector<GLuint> indices);
 
     void rotate(glm::mat4& rotateMatrix, GLfloat angle, glm::vec3 axis, GLfloat slerp);
 
+    /**
+     * Recompute the model and normal matrices if the model has moved.
+     *
+     * @return whether they were recomputed
+     */
+    bool updateTransform();
+
     void doRotation();
 };
 
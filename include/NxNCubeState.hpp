@@ -0,0 +1,113 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * Sticker-level state of an N x N x N cube, for sizes the cubie-level CubeState cannot
+ * represent. Each face is its own N x N plane of stickers, row by row as seen from outside the
+ * cube, with faces and rows laid out as for Facelets. A sticker holds the face its colour
+ * belongs to.
+ *
+ * A turn moves one layer, counted inwards from a face: the four strips of stickers it carries
+ * from the neighbouring faces are cycled by strided copies, and turning an outer layer also
+ * rotates that face's plane in place, as a reversal of its row order and a transpose in 16 x 16
+ * tiles. A slice turn therefore costs O(N) and an outer turn O(N^2).
+ *
+ * @author mdq3
+ */
+
+#ifndef NXNCUBESTATE_H_
+#define NXNCUBESTATE_H_
+
+#include <cstdint>
+#include <vector>
+#include "CubeState.hpp"
+
+/**
+ *
+ */
+class NxNCubeState {
+ public:
+    /**
+     * Constructor for NxNCubeState. Creates the solved state.
+     *
+     * @param size The number of layers, at least 2
+     */
+    explicit NxNCubeState(int size);
+
+    /**
+     * Turn one layer clockwise, as seen from a face.
+     *
+     * @param face The face, as for CubeState
+     * @param layer The layer counted from that face, 0 for the face itself up to size - 1 for
+     *        the opposite face
+     * @param turns The number of quarter turns, 1 to 3
+     */
+    void turn(int face, int layer, int turns);
+
+    /**
+     * Apply a face turn of the outer layer, with the move index as for CubeState.
+     */
+    void apply(int move);
+
+    int getSize() const;
+
+    /**
+     * Get the face whose colour a sticker has.
+     *
+     * @param face The face the sticker is on
+     * @param row The row on that face, seen from outside the cube
+     * @param column The column on that face
+     */
+    int getSticker(int face, int row, int column) const;
+
+    /**
+     * Recolour a sticker, e.g. to load a state read from elsewhere.
+     *
+     * @param colour The face whose colour the sticker gets
+     */
+    void setSticker(int face, int row, int column, int colour);
+
+    /**
+     * Get the stickers of a face, size * size of them row by row.
+     */
+    const uint8_t* getFace(int face) const;
+
+    /**
+     * Check whether every face is one colour, so a cube turned as a whole is also solved.
+     */
+    bool isSolved() const;
+
+    bool operator==(const NxNCubeState& other) const;
+    bool operator!=(const NxNCubeState& other) const;
+
+ private:
+    int size;
+    std::vector<uint8_t> stickers; // Six faces of size * size, in the order U, R, F, D, L, B
+    std::vector<uint8_t> strip;    // Scratch space for one strip while cycling
+
+    uint8_t* face(int f);
+
+    /**
+     * Rotate the stickers of a face in place by a number of clockwise quarter turns.
+     */
+    void rotateFace(int f, int turns);
+};
+
+#endif // NXNCUBESTATE_H_
@@ -0,0 +1,185 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Optimal solver in the half-turn metric, after Korf. IDA* over the full cube state, bounded by
+ * three pattern databases: all eight corners and two groups of six edges (42M entries each).
+ * Every entry is a 4-bit distance, two to a byte. The corner database holds one entry per class
+ * of corner states the 16 U-D symmetries map onto each other (6M entries rather than 88M), small
+ * enough to stay in cache. Each node also looks up the databases for its inverse state (the dual
+ * state), and the entries of all children are prefetched before any of them is examined. Moves
+ * at the root that a symmetry of the scramble maps onto a lower move are not searched.
+ *
+ * The databases are built once and saved to resources/tables/optimal.tbl. Later runs map that
+ * file instead of building them, and every solver instance shares the one copy.
+ *
+ * With more than one thread, each iteration of the search is split at a fixed depth and the
+ * subtrees below it are searched on a work-stealing pool. The first thread to find a solution
+ * stops the others, so which of several optimal solutions is returned can vary between runs.
+ *
+ * @author mdq3
+ */
+
+#ifndef OPTIMALSOLVER_H_
+#define OPTIMALSOLVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "CubeState.hpp"
+#include "SolutionCache.hpp"
+#include "WorkStealingPool.hpp"
+
+/**
+ *
+ */
+class OptimalSolver {
+ public:
+    /**
+     * Called at the start of each iteration of a solve, with the depth about to be searched and
+     * the number of nodes generated so far.
+     */
+    typedef std::function<void(int depth, uint64_t nodes)> Progress;
+
+    /**
+     * Constructor for OptimalSolver. Loads the shared pattern databases if they are not loaded
+     * yet, building them first if there is no table file, which takes about a minute.
+     *
+     * @param threads The number of search threads, or 0 for one per hardware thread
+     * @param splitDepth The depth at which the search tree is split into parallel subtrees
+     */
+    explicit OptimalSolver(int threads = 1, int splitDepth = 3);
+
+    ~OptimalSolver();
+
+    /**
+     * Find a shortest solution of a cube state.
+     *
+     * @param state The state to solve
+     * @param solution Set to the moves solving the state
+     * @param maxLength Give up once no solution of up to this many moves exists
+     * @return true if a solution was found
+     */
+    bool solve(const CubeState& state, std::vector<int>& solution, int maxLength = 20);
+
+    /**
+     * Get the number of nodes generated by the current or last solve. Can be read from another
+     * thread while a solve is running; each thread adds its nodes to the count every 65536, so
+     * it lags by up to that many per thread.
+     */
+    uint64_t getNodeCount() const;
+
+    /**
+     * Get the wall time of the last solve in seconds.
+     */
+    double getElapsedSeconds() const;
+
+    /**
+     * Get the search rate of the last solve.
+     */
+    double getNodesPerSecond() const;
+
+    /**
+     * Get the pattern database lower bound on the distance of a state, including the dual
+     * lookup.
+     */
+    static int estimate(const CubeState& state);
+
+    /**
+     * Map the shared pattern databases from the table file, or build them and write the file if
+     * it is missing or invalid. Does nothing once the databases are loaded. Safe to call from
+     * several threads.
+     *
+     * @return the number of seconds spent loading the databases, 0 if they were already loaded
+     */
+    static double initTables();
+
+    int getThreadCount() const;
+
+    /**
+     * Look solutions up in a cache before searching, and add the solutions found to it.
+     *
+     * @param cache The cache, shared with other solvers, or nullptr for none
+     */
+    void setCache(SolutionCache* cache);
+
+    void setProgress(Progress progress);
+
+    /**
+     * Give up solves, returning false, while a flag is set. Each thread checks it whenever it
+     * adds to the node count, so it can be set from another thread to stop a solve in progress
+     * within a few milliseconds.
+     *
+     * @param cancelled The flag, or nullptr for none
+     */
+    void setCancelFlag(const std::atomic<bool>* cancelled);
+
+ private:
+    static const int MAX_DEPTH = 32;
+    static const int MAX_SPLIT_DEPTH = 6;
+
+    /**
+     * Search stack and unflushed node count of one thread.
+     */
+    struct Worker
+    {
+        uint64_t nodes;
+        int moves[MAX_DEPTH];
+    };
+
+    /**
+     * A node at the split depth, searched as one task.
+     */
+    struct Subtree
+    {
+        CubeState state;
+        int moves[MAX_SPLIT_DEPTH];
+    };
+
+    int splitDepth;
+    std::vector<Worker> workers;            // One per thread
+    std::unique_ptr<WorkStealingPool> pool; // Only with more than one thread
+    std::atomic<bool> stop;                 // Set once a solution is found
+    std::atomic<uint64_t> nodes;            // Shared by all threads
+    std::mutex resultMutex;
+    std::vector<int> result;                // Solution found by the parallel search
+    uint64_t symmetries;                    // Symmetries of the state being solved
+    double elapsed;
+    SolutionCache* cache;
+    Progress progress;
+    const std::atomic<bool>* cancelled;
+
+    OptimalSolver(const OptimalSolver&) = delete;
+    OptimalSolver& operator=(const OptimalSolver&) = delete;
+
+    bool searchParallel(const CubeState& state, int bound);
+
+    void split(const CubeState& state, int depth, int togo, std::vector<Subtree>& subtrees);
+
+    void searchSubtree(Worker& worker, const Subtree& subtree, int bound);
+
+    bool search(Worker& worker, const CubeState& state, int depth, int togo);
+
+    bool isCancelled() const;
+};
+
+#endif // OPTIMALSOLVER_H_
@@ -0,0 +1,116 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Pruning tables of 4-bit distances from the solved state, two entries to a byte, shared by the
+ * solvers whose tables are too large for a byte per entry. A table is filled breadth-first over
+ * entry indices; what an index stands for is up to its solver.
+ *
+ * @author mdq3
+ */
+
+#ifndef PATTERNDATABASE_H_
+#define PATTERNDATABASE_H_
+
+#include <cstdint>
+#include <vector>
+#include "CubeState.hpp"
+#include "Symmetry.hpp"
+
+/**
+ *
+ */
+class PatternDatabase {
+ public:
+    static const uint8_t UNVISITED = 15;
+    static const int MAX_NEIGHBOURS = CubeState::N_MOVES * Symmetry::N_UD_SYMMETRIES; // Moves, each with the equivalent entries of its result
+
+    static int lookup(const uint8_t* table, uint64_t index)
+    {
+        return (table[index >> 1] >> ((index & 1) << 2)) & 15;
+    }
+
+    static void store(uint8_t* table, uint64_t index, int value)
+    {
+        int shift = (index & 1) << 2;
+        table[index >> 1] = (uint8_t)((table[index >> 1] & ~(15 << shift)) | (value << shift));
+    }
+
+    static void prefetch(const uint8_t* table, uint64_t index)
+    {
+        __builtin_prefetch(table + (index >> 1));
+    }
+
+    /**
+     * Breadth-first fill of a table. Early levels expand the frontier forwards; once the
+     * frontier outnumbers the unvisited entries, each unvisited entry instead looks for a
+     * neighbour on the frontier, which touches far fewer entries.
+     *
+     * @param table The table to fill
+     * @param size The number of entries
+     * @param solved The index of the solved state
+     * @param neighbours Fills an array with the indices one move away from an index, at most
+     *                   MAX_NEIGHBOURS of them, and returns how many it filled
+     */
+    template <typename Neighbours>
+    static void build(std::vector<uint8_t>& table, uint64_t size, uint64_t solved, Neighbours neighbours)
+    {
+        table.assign((size + 1) / 2, 0xFF);
+        store(table.data(), solved, 0);
+        uint64_t visited = 1;
+        uint64_t frontier = 1;
+        uint64_t next[MAX_NEIGHBOURS];
+        for(int depth = 0; frontier > 0; ++depth)
+        {
+            bool backward = frontier > size - visited;
+            frontier = 0;
+            for(uint64_t i = 0; i < size; ++i)
+            {
+                int value = lookup(table.data(), i);
+                if(backward && value == UNVISITED)
+                {
+                    int count = neighbours(i, next);
+                    for(int k = 0; k < count; ++k)
+                    {
+                        if(lookup(table.data(), next[k]) == depth)
+                        {
+                            store(table.data(), i, depth + 1);
+                            ++frontier;
+                            break;
+                        }
+                    }
+                }
+                else if(!backward && value == depth)
+                {
+                    int count = neighbours(i, next);
+                    for(int k = 0; k < count; ++k)
+                    {
+                        if(lookup(table.data(), next[k]) == UNVISITED)
+                        {
+                            store(table.data(), next[k], depth + 1);
+                            ++frontier;
+                        }
+                    }
+                }
+            }
+            visited += frontier;
+        }
+    }
+};
+
+#endif // PATTERNDATABASE_H_
@@ -30,7 +30,9 @@
 #include <glm/glm.hpp>
 #include "Camera.hpp"
 #include "Cube.hpp"
+#include "FrameUniforms.hpp"
 #include "Model.hpp"
+#include "TextureArray.hpp"
 
 #include <memory>
 #include "Light.hpp"
@@ -38,7 +40,12 @@
 class Scene {
  public:
 
-    Scene(int width, int height);
+    /**
+     * Constructor for Scene.
+     *
+     * @param cubeSize The number of layers of the cube puzzle
+     */
+    Scene(int width, int height, int cubeSize);
 
     ~Scene();
 
@@ -53,12 +60,12 @@ class Scene {
     void initShadowMap(int windowWidth, int windowHeight);
 
     /**
-     * Render the entire scene.
+     * Render the entire scene. The shadow map is redrawn only when the cubies have moved.
      */
     void render();
 
     /**
-     * Render the scene from light's POV into depth frame buffer.
+     * Render the scene from light's POV into depth frame buffer. Only the cubies cast shadows.
      */
     void shadowPass();
 
@@ -72,6 +79,12 @@ class Scene {
     Camera& getCamera();
     GLfloat getCameraSpeed();
 
+    /**
+     * Get the number of matrices recomputed in the last frame rendered, counting one per matrix
+     * as the camera, the models and the cube all do. Zero while nothing moves.
+     */
+    unsigned long getFrameTransformUpdates();
+
     /**
      * Get the camera position.
      *
@@ -92,21 +105,34 @@ class Scene {
     void handleCamera();
 
     /**
-     * Send lights and camera data to the currently active shader.
+     * Send this frame's lights, camera and shadow transforms to every shader, if they changed.
      */
-    void updateLightsAndCamera();
+    void updateFrameUniforms();
 
  private:
     Camera camera;
     GLfloat cameraSpeed;
     Cube cube;
+    int cubeSize;
     Model plane;
+    TextureArray textures;         // The textures of every model
     GLuint currentShaderProgram;
+    GLuint cubieShaderProgram;     // Shader program for the instanced cubies
 
     GLuint FBOshadow;              // Framebuffer object for shadow mapping
     GLuint shadowMap;              // The texture for shadow mapping
-    glm::mat4 depthBiasMVP;        // The view projection matrix in light-space for shadow map rendering
-    GLuint shaderProgramShadowMap; // Shader program for rendering shadow map
+    GLuint cubieShadowMapProgram;  // Shader program for rendering the cubies into the shadow map
+    FrameUniforms frameUniforms;   // Per-frame data shared by every shader program
+
+    glm::mat4 shadowViewProjectionMatrix; // Light space, for rendering the shadow map
+    glm::mat4 depthBiasMVP;               // Light space to shadow map coordinates
+
+    unsigned long transformUpdates;      // Matrices the scene itself has computed
+    unsigned long lastTransformUpdates;  // Matrices computed by everything, up to the last frame
+    unsigned long frameTransformUpdates; // Matrices computed in the last frame
+
+    unsigned long shadowPlacements; // Cube placement count the shadow map was drawn at
+    bool shadowMapValid;            // Whether the shadow map has been drawn since it was created
 
     std::vector<std::unique_ptr<Lighter>> lights;
 
@@ -130,7 +156,8 @@ class Scene {
 
     /**
      * Reads shader source from file, compiles and attaches shader to
-     * shader program.
+     * shader program. The Frame block declarations in frame.glsl are inserted after the
+     * #version line.
      *
      * @param shaderProgram The shader program to attach the compiled shader to
      * @param file The path of the source file to be read
@@ -139,7 +166,8 @@ class Scene {
     void addShader(GLuint shaderProgram, const char* file, GLenum shaderType);
 
     /**
-     * Create the shader program for use with this model.
+     * Create the shader program for use with this model. Its Frame block and texture units are
+     * set up once here rather than on every frame.
      *
      * @param vertShaderPath The path of the source file for the vertex shader
      * @param fragShaderPath The path of the source file for the fragment shader
@@ -0,0 +1,84 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Generator of uniformly random solvable cube states, for load-testing solvers. Each state is
+ * drawn directly rather than by turning faces: the corner and edge permutations as uniform ranks
+ * in 0 to 8! - 1 and 0 to 12! - 1, with two edges swapped when the parities differ, and the twist
+ * and flip as uniform coordinates. Every solvable state comes from exactly two draws, so all of
+ * them are equally likely.
+ *
+ * Each instance has its own seeded random number generator, so use one per thread; a seed and
+ * stream number always give the same states.
+ *
+ * @author mdq3
+ */
+
+#ifndef SCRAMBLER_H_
+#define SCRAMBLER_H_
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include "CubeState.hpp"
+#include "TwoPhaseSolver.hpp"
+
+/**
+ *
+ */
+class Scrambler {
+ public:
+    /**
+     * Constructor for Scrambler.
+     *
+     * @param seed The seed of the random number generator
+     * @param stream Distinguishes generators with the same seed, e.g. the thread number
+     */
+    explicit Scrambler(uint64_t seed, uint64_t stream = 0);
+
+    ~Scrambler();
+
+    /**
+     * Generate a uniformly random solvable state.
+     */
+    CubeState next();
+
+    /**
+     * Generate a uniformly random solvable state and a sequence of moves that turns the solved
+     * cube into it: the inverse of a two-phase solution, so much slower than next(). Loads the
+     * two-phase tables on first use.
+     *
+     * @param scramble Set to the moves
+     */
+    CubeState next(std::vector<int>& scramble);
+
+ private:
+    std::mt19937_64 random;
+    std::uniform_int_distribution<int> cornerPermutations;
+    std::uniform_int_distribution<int> edgePermutations;
+    std::uniform_int_distribution<int> twists;
+    std::uniform_int_distribution<int> flips;
+    std::unique_ptr<TwoPhaseSolver> solver; // Created on the first scramble sequence
+
+    Scrambler(const Scrambler&) = delete;
+    Scrambler& operator=(const Scrambler&) = delete;
+};
+
+#endif // SCRAMBLER_H_
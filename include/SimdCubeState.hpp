@@ -0,0 +1,112 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Cubie-level cube state laid out for byte shuffles. The twelve edges are the first 16 bytes
+ * and the eight corners the second 16, one byte per position holding the cubie in the low four
+ * bits and its orientation times 16 in the high four. A face turn is then one byte shuffle of
+ * each half by the move's permutation, an add of the move's orientation changes, and a
+ * subtraction of 32 (edges) or 48 (corners) from the bytes that overflowed.
+ *
+ * With AVX2 both halves are turned by the same four instructions; with SSSE3 each half is
+ * turned separately; otherwise the bytes are shuffled one at a time. The fastest path the CPU
+ * supports is picked at startup.
+ *
+ * Has the same interface as CubeState for turning and reading a state, including cubieAt for
+ * Cube's face rotations, and converts to and from it.
+ *
+ * @author mdq3
+ */
+
+#ifndef SIMDCUBESTATE_H_
+#define SIMDCUBESTATE_H_
+
+#include <cstdint>
+#include <vector>
+#include "CubeState.hpp"
+
+/**
+ *
+ */
+class SimdCubeState {
+ public:
+    enum Level { SCALAR, SSSE3, AVX2 };
+
+    /**
+     * Constructor for SimdCubeState. Creates the solved state.
+     */
+    SimdCubeState();
+
+    explicit SimdCubeState(const CubeState& state);
+
+    CubeState toCubeState() const;
+
+    /**
+     * Apply a single face turn.
+     *
+     * @param move The move index, as for CubeState
+     */
+    void apply(int move);
+
+    /**
+     * Apply a sequence of face turns in order, keeping the state in registers throughout.
+     */
+    void apply(const std::vector<int>& moves);
+
+    void apply(const int* moves, int count);
+
+    int cornerPermutation(int position) const;
+    int cornerOrientation(int position) const;
+    int edgePermutation(int position) const;
+    int edgeOrientation(int position) const;
+
+    bool isSolved() const;
+
+    /**
+     * Index, in the 26-cubie layout used by Cube, of the cubie occupying a slot. See
+     * CubeState::cubieAt.
+     */
+    int cubieAt(int slot) const;
+
+    bool operator==(const SimdCubeState& other) const;
+    bool operator!=(const SimdCubeState& other) const;
+
+    /**
+     * Get the code path used to apply moves.
+     */
+    static Level getLevel();
+
+    /**
+     * Get the fastest code path the CPU supports.
+     */
+    static Level getSupportedLevel();
+
+    /**
+     * Force a slower code path, e.g. to compare them. Levels the CPU does not support are
+     * lowered to the supported level. Not safe to call while other threads apply moves.
+     */
+    static void setLevel(Level level);
+
+    static const char* levelName(Level level);
+
+ private:
+    alignas(32) uint8_t bytes[32]; // Edges in bytes 0-11, corners in 16-23, the rest unused
+};
+
+#endif // SIMDCUBESTATE_H_
@@ -0,0 +1,155 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Bounded cache of solutions shared by solver threads. Positions are keyed by the
+ * representative of their class under the 48 symmetries, so a position hits if any of its
+ * conjugates was solved before; the stored solution is conjugated back on the way out.
+ *
+ * Entries are spread over shards, each with its own lock, and evicted with the CLOCK
+ * algorithm: a hit marks an entry, and a full shard replaces the first unmarked entry after the
+ * clock hand, clearing marks as the hand passes them.
+ *
+ * The cache can be saved to and loaded from a table file, so a restarted process starts warm.
+ *
+ * @author mdq3
+ */
+
+#ifndef SOLUTIONCACHE_H_
+#define SOLUTIONCACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "CubeState.hpp"
+
+/**
+ *
+ */
+class SolutionCache {
+ public:
+    enum Solver { TWO_PHASE, OPTIMAL }; // Solutions of each solver are kept apart
+
+    static const int MAX_LENGTH = 30;   // Longer solutions are not cached
+
+    /**
+     * Constructor for SolutionCache.
+     *
+     * @param capacity The maximum number of solutions held, at least 1. Each shard holds an equal
+     *                 share rounded down, so up to shardCount - 1 fewer may be held in all
+     * @param shardCount The number of independently locked shards, reduced to the capacity if
+     *                   it is larger
+     */
+    explicit SolutionCache(size_t capacity, int shardCount = 16);
+
+    ~SolutionCache();
+
+    /**
+     * Look up a solution of a state.
+     *
+     * @param solver The solver whose solutions to look up
+     * @param state The state to solve
+     * @param maxLength A cached solution longer than this is a miss
+     * @param solution Set to the moves solving the state on a hit
+     * @return true on a hit
+     */
+    bool lookup(Solver solver, const CubeState& state, int maxLength, std::vector<int>& solution);
+
+    /**
+     * Add a solution of a state, replacing any held for it.
+     */
+    void insert(Solver solver, const CubeState& state, const std::vector<int>& solution);
+
+    uint64_t getHits() const;
+    uint64_t getMisses() const;
+    uint64_t getEvictions() const;
+
+    /**
+     * Get the number of solutions held.
+     */
+    size_t getSize();
+
+    size_t getCapacity() const;
+
+    /**
+     * Add the solutions saved in a file. Solutions that do not solve their state are skipped.
+     *
+     * @return false if the file does not exist or is not a saved cache
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Save every solution held to a file, replacing it atomically.
+     */
+    bool save(const std::string& path);
+
+ private:
+    typedef std::pair<uint64_t, uint64_t> Key;
+
+    /**
+     * A cached solution of a representative state, also the record saved to file.
+     */
+    struct Entry
+    {
+        CubeState state;
+        uint8_t solver;
+        uint8_t length;
+        int8_t moves[MAX_LENGTH];
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        std::vector<uint8_t> referenced;           // CLOCK mark of each entry
+        std::unordered_map<Key, uint32_t, KeyHash> index; // Position of each key in entries
+        size_t hand;                               // Next entry the clock considers
+    };
+
+    size_t capacity;
+    size_t shardCapacity;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+
+    SolutionCache(const SolutionCache&) = delete;
+    SolutionCache& operator=(const SolutionCache&) = delete;
+
+    static Key makeKey(int solver, const CubeState& state);
+
+    Shard& shardOf(const Key& key);
+
+    /**
+     * Add an entry for a representative state.
+     */
+    void insertEntry(const Entry& entry);
+};
+
+#endif // SOLUTIONCACHE_H_
@@ -0,0 +1,148 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * Background thread that solves cube states for a render loop without ever blocking it. The
+ * loop hands over a snapshot of the state with solve() and polls for messages each frame:
+ * progress at the start of each search iteration, then the solution. Messages come back through
+ * a lock-free Mailbox, so polling never waits on the solver.
+ *
+ * A new request or cancel() stops the solve in progress within a few thousand search nodes.
+ * Messages about a stopped request may already be in the mailbox, so each carries the number
+ * of its request. The solver and its tables are loaded on the worker thread on the first
+ * request.
+ *
+ * @author mdq3
+ */
+
+#ifndef SOLVERWORKER_H_
+#define SOLVERWORKER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CubeState.hpp"
+#include "Mailbox.hpp"
+#include "OptimalSolver.hpp"
+#include "SolutionCache.hpp"
+#include "TwoPhaseSolver.hpp"
+
+/**
+ *
+ */
+class SolverWorker {
+ public:
+    static const int MAX_LENGTH = 32;
+
+    /**
+     * News of a request, posted by the worker.
+     */
+    struct Message
+    {
+        enum Type { PROGRESS, SOLVED, FAILED };
+
+        Type type;
+        unsigned int request;     // The number solve() returned for the request
+        int depth;                // Depth being searched, or the solution length once solved
+        uint64_t nodes;           // Nodes generated so far
+        double seconds;           // Time since the worker took the request
+        int8_t moves[MAX_LENGTH]; // The solution, when solved
+
+        std::vector<int> getSolution() const;
+    };
+
+    /**
+     * Constructor for SolverWorker. Starts the thread.
+     *
+     * @param solver Which solver to use
+     */
+    explicit SolverWorker(SolutionCache::Solver solver = SolutionCache::TWO_PHASE);
+
+    /**
+     * Destructor for SolverWorker. Stops any solve and joins the thread.
+     */
+    ~SolverWorker();
+
+    /**
+     * Start solving a state, stopping any solve in progress. Only call from the polling thread.
+     *
+     * @param state The state to solve
+     * @return the request number the messages about it will carry
+     */
+    unsigned int solve(const CubeState& state);
+
+    /**
+     * Stop any solve in progress, e.g. because the cube it was solving has been turned.
+     */
+    void cancel();
+
+    /**
+     * Take the next message, if any. Never blocks. Only call from one thread.
+     *
+     * @return false if there is no message
+     */
+    bool poll(Message& message);
+
+    /**
+     * Check whether a request is waiting or being solved.
+     */
+    bool isBusy() const;
+
+ private:
+    static const size_t MAILBOX_SIZE = 64;
+
+    SolutionCache::Solver solverType;
+    std::unique_ptr<TwoPhaseSolver> twoPhase; // Created on the worker thread when first needed
+    std::unique_ptr<OptimalSolver> optimal;
+    Mailbox<Message, MAILBOX_SIZE> mailbox;
+
+    std::mutex mutex;
+    std::condition_variable wake;         // Signals a new request or quit
+    CubeState pendingState;               // The request waiting to be taken
+    unsigned int pendingRequest;          // Its number, 0 if none is waiting
+    bool quit;
+    unsigned int requests;                // Requests made so far
+    std::atomic<unsigned int> current;    // The request still wanted, 0 after a cancel
+    std::atomic<bool> cancelled;          // Stops the solve in progress
+    std::atomic<bool> busy;
+    std::thread thread;
+
+    SolverWorker(const SolverWorker&) = delete;
+    SolverWorker& operator=(const SolverWorker&) = delete;
+
+    void work();
+
+    /**
+     * Solve one request and post its messages, unless it is cancelled first.
+     */
+    void run(const CubeState& state, unsigned int request);
+
+    /**
+     * Post a message, unless the request it is about has been stopped. Progress is dropped if
+     * the mailbox is full; a result waits for room.
+     */
+    void deliver(const Message& message);
+};
+
+#endif // SOLVERWORKER_H_
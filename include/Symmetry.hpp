@@ -0,0 +1,114 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * The 48 symmetries of the cube, the rotations and reflections that map it onto itself, and
+ * the tables that let solvers store one entry per class of symmetric states.
+ *
+ * Symmetry 16 * a + 8 * b + 2 * c + d is the product of a 120 degree turn about the URF-DBL
+ * diagonal a times, a half turn about the F-B axis b times, a quarter turn about the U-D axis c
+ * times and a reflection through the R-L plane d times. The first 16 keep the U-D axis and map
+ * the phase 1 subgroup of the two-phase solver onto itself.
+ *
+ * Conjugating a state by symmetry s turns it into S * state * S^-1, the state seen from the
+ * other side: it is solved by the conjugated moves of any solution of the original, and so has
+ * the same distance from solved.
+ *
+ * @author mdq3
+ */
+
+#ifndef SYMMETRY_H_
+#define SYMMETRY_H_
+
+#include <cstdint>
+#include <vector>
+#include "CubeState.hpp"
+
+/**
+ *
+ */
+class Symmetry {
+ public:
+    static const int N_SYMMETRIES    = 48;
+    static const int N_UD_SYMMETRIES = 16; // Symmetries 0-15 keep the U-D axis
+
+    /**
+     * Conjugate a state by a symmetry.
+     *
+     * @return S * state * S^-1
+     */
+    static CubeState conjugate(const CubeState& state, int symmetry);
+
+    /**
+     * Get the move that a move turns into under a symmetry, S * move * S^-1.
+     */
+    static int conjugateMove(int move, int symmetry);
+
+    static int inverse(int symmetry);
+
+    /**
+     * Get the representative of the states a state is conjugate to under all 48 symmetries,
+     * the conjugate with the lowest corner and then edge word. Conjugate states share it.
+     *
+     * @param canonical Set to the representative
+     * @return a symmetry that conjugates the state into the representative
+     */
+    static int representative(const CubeState& state, CubeState& canonical);
+
+    /**
+     * Get the symmetries that leave a state unchanged.
+     *
+     * @return a mask with bit s set if conjugating by symmetry s gives the same state
+     */
+    static uint64_t getSymmetries(const CubeState& state);
+
+    /**
+     * Whether a first move is a duplicate of a lower one: a symmetry of the state turns it into
+     * the lower move, so the subtree below it is the conjugate of one already searched.
+     *
+     * @param symmetries A mask from getSymmetries
+     */
+    static bool isDuplicateMove(int move, uint64_t symmetries);
+
+    /**
+     * Build a table of a coordinate conjugated by each of the 16 U-D symmetries: entry
+     * [value * 16 + symmetry]. Only valid for coordinates whose conjugate does not depend on
+     * the rest of the state, such as the corner twist.
+     */
+    static void buildConjugationTable(std::vector<uint16_t>& table, int size, int (*get)(const CubeState&),
+                                      void (*set)(CubeState&, int));
+
+    /**
+     * Divide the values of a coordinate into classes of values that the 16 U-D symmetries map
+     * onto each other. The lowest value of each class is its representative.
+     *
+     * @param size The number of coordinate values
+     * @param get The coordinate getter
+     * @param set The coordinate setter
+     * @param classOf Set to the class of each value
+     * @param symmetryOf Set to the symmetry that conjugates each value into its representative
+     * @param representatives Set to the representative of each class
+     * @return the number of classes
+     */
+    static int buildClasses(int size, int (*get)(const CubeState&), void (*set)(CubeState&, int),
+                            std::vector<uint16_t>& classOf, std::vector<uint8_t>& symmetryOf,
+                            std::vector<uint32_t>& representatives);
+};
+
+#endif // SYMMETRY_H_
@@ -0,0 +1,125 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Binary file of named solver tables, mapped read-only into memory so that every process
+ * solving on the machine shares the same pages through the page cache.
+ *
+ * The file starts with a header and a directory of tables, each with its offset, size and a
+ * checksum of its contents. Tables start on page boundaries. Opening a file checks only the
+ * header and directory; the table contents are checksummed afterwards on a background thread
+ * while the tables are already in use. A file that fails is marked corrupt, so the solvers stop
+ * using its tables, and is deleted so the next run builds a new one.
+ *
+ * @author mdq3
+ */
+
+#ifndef TABLEFILE_H_
+#define TABLEFILE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ *
+ */
+class TableFile {
+ public:
+    /**
+     * A table to write to a file.
+     */
+    struct Entry
+    {
+        std::string name;
+        const void* data;
+        uint64_t size; // In bytes
+    };
+
+    TableFile();
+
+    /**
+     * Destructor for TableFile. Waits for verification and unmaps the file.
+     */
+    ~TableFile();
+
+    /**
+     * Map a table file read-only and check its header and directory.
+     *
+     * @param path The path of the file
+     * @return true if the file exists and its header and directory are valid
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Get a table from the mapped file.
+     *
+     * @param name The table name
+     * @param size The expected size of the table in bytes
+     * @return the table contents, or nullptr if there is no such table of that size
+     */
+    const void* getTable(const std::string& name, uint64_t size) const;
+
+    /**
+     * Start checksumming the table contents on a background thread.
+     */
+    void verifyInBackground();
+
+    /**
+     * Wait for verification to finish.
+     *
+     * @return true if every table matched its checksum
+     */
+    bool waitForVerification();
+
+    /**
+     * Whether verification found a table that does not match its checksum. A solver must not
+     * return results found with the tables of a corrupt file.
+     */
+    bool isCorrupt() const;
+
+    /**
+     * Write tables to a file. The file is written under a temporary name and renamed into
+     * place, so other processes never map a partly written file.
+     *
+     * @param path The path of the file
+     * @param tables The tables to write
+     * @return true if the file was written
+     */
+    static bool write(const std::string& path, const std::vector<Entry>& tables);
+
+ private:
+    std::string path;
+    const uint8_t* data;
+    uint64_t size;
+    std::thread verifier;
+    std::atomic<bool> valid;
+    std::atomic<bool> corrupt;
+
+    TableFile(const TableFile&) = delete;
+    TableFile& operator=(const TableFile&) = delete;
+
+    void verify();
+
+    static uint64_t checksum(const uint8_t* bytes, uint64_t size);
+};
+
+#endif // TABLEFILE_H_
@@ -0,0 +1,72 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * The textures of a scene's models, decoded once at load time and packed as the layers of a
+ * single GL_TEXTURE_2D_ARRAY. A model samples its own layer, which it carries in its vertices,
+ * so the array is bound to its texture unit once and never rebound between draws.
+ *
+ * @author mdq3
+ */
+
+#ifndef TEXTUREARRAY_H_
+#define TEXTUREARRAY_H_
+
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+/**
+ *
+ */
+class TextureArray {
+ public:
+    TextureArray();
+
+    ~TextureArray();
+
+    /**
+     * Decode the images and upload them as the layers of the texture array. A path given more
+     * than once gets a single layer. Every image must be the same size. Needs a GL context.
+     *
+     * @param paths The image files, e.g. the texture paths of every mesh in a q3d file
+     */
+    void load(const std::vector<std::string>& paths);
+
+    /**
+     * Get the layer an image was loaded into.
+     *
+     * @return the layer, as the texture coordinate selecting it, or -1 if it was not loaded
+     */
+    GLfloat getLayer(const std::string& path) const;
+
+    /**
+     * Bind the texture array to a texture unit.
+     *
+     * @param unit The texture unit, e.g. GL_TEXTURE1
+     */
+    void bind(GLenum unit) const;
+
+ private:
+    GLuint texture;
+    std::vector<std::string> layers; // Image path of each layer
+};
+
+#endif // TEXTUREARRAY_H_
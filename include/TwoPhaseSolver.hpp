@@ -0,0 +1,135 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Kociemba's two-phase solver. Phase 1 searches with the twist, flip and UD-slice coordinates
+ * until the cube is in the subgroup <U, D, R2, L2, F2, B2>; phase 2 then solves it within that
+ * subgroup using the corner, U/D edge and slice permutation coordinates. Both phases are IDA*
+ * searches over precomputed move and pruning tables. Phase 1 is bounded by its exact distance,
+ * from a table of the twist against the flip and slice coordinates with one entry per class of
+ * the 16 U-D symmetries (141M 4-bit entries rather than 2.2G). Each depth is searched from six
+ * starts: the state and its inverse, each seen along the three axes.
+ *
+ * The tables are built once (about 20 seconds) and saved to resources/tables/twophase.tbl;
+ * later runs map that file instead, and every solver instance shares the one copy. An instance
+ * holds only its own search stack, so use one per thread.
+ *
+ * @author mdq3
+ */
+
+#ifndef TWOPHASESOLVER_H_
+#define TWOPHASESOLVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "CubeState.hpp"
+#include "SolutionCache.hpp"
+
+/**
+ *
+ */
+class TwoPhaseSolver {
+ public:
+    /**
+     * Called at the start of each iteration of a solve, with the phase 1 depth about to be
+     * searched and the number of phase 1 nodes visited so far.
+     */
+    typedef std::function<void(int depth, uint64_t nodes)> Progress;
+
+    /**
+     * Constructor for TwoPhaseSolver. Loads the shared tables if they are not loaded yet.
+     */
+    TwoPhaseSolver();
+
+    ~TwoPhaseSolver();
+
+    /**
+     * Solve a cube state.
+     *
+     * @param state The state to solve
+     * @param solution Set to the moves solving the state
+     * @param maxLength The maximum number of moves allowed in the solution
+     * @return true if a solution of at most maxLength moves was found
+     */
+    bool solve(const CubeState& state, std::vector<int>& solution, int maxLength = 20);
+
+    /**
+     * Get the number of phase 1 nodes visited by the last solve.
+     */
+    uint64_t getNodeCount() const;
+
+    /**
+     * Map the shared move and pruning tables from the table file, or build them and write the
+     * file if it is missing or invalid. Does nothing once the tables are loaded. Safe to call
+     * from several threads.
+     *
+     * @return the number of seconds spent loading the tables, 0 if they were already loaded
+     */
+    static double initTables();
+
+    /**
+     * Look solutions up in a cache before searching, and add the solutions found to it.
+     *
+     * @param cache The cache, shared with other solvers, or nullptr for none
+     */
+    void setCache(SolutionCache* cache);
+
+    void setProgress(Progress progress);
+
+    /**
+     * Give up solves, returning false, while a flag is set. The flag is checked every few
+     * thousand nodes, so it can be set from another thread to stop a solve in progress.
+     *
+     * @param cancelled The flag, or nullptr for none
+     */
+    void setCancelFlag(const std::atomic<bool>* cancelled);
+
+ private:
+    static const int MAX_DEPTH = 32;
+
+    SolutionCache* cache;
+    Progress progress;
+    const std::atomic<bool>* cancelled;
+    uint64_t nodes;   // Phase 1 nodes visited by the current solve
+    bool stopped;     // Set once the current solve is cancelled
+    CubeState start;
+    uint64_t symmetries; // U-D symmetries of the start being searched
+    int maxLength;
+    int moves[MAX_DEPTH];
+
+    // Phase 1 coordinates at each depth
+    int twist[MAX_DEPTH];
+    int flip[MAX_DEPTH];
+    int slice[MAX_DEPTH];
+
+    // Phase 2 coordinates at each depth
+    int cornerPerm[MAX_DEPTH];
+    int edgePerm[MAX_DEPTH];
+    int slicePerm[MAX_DEPTH];
+
+    bool searchPhase1(int depth, int togo);
+
+    bool startPhase2(int depth);
+
+    bool searchPhase2(int depth, int togo);
+};
+
+#endif // TWOPHASESOLVER_H_
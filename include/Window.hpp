@@ -31,6 +31,7 @@
 #include <SDL2/SDL_opengl.h>
 #include <glm/glm.hpp>
 #include "Scene.hpp"
+#include "SolverWorker.hpp"
 
 /**
  *
@@ -42,8 +43,9 @@ class Window {
      *
      * @param width The initial width of the window
      * @param height The initial height of the window
+     * @param cubeSize The number of layers of the cube puzzle
      */
-    Window(int width, int height);
+    Window(int width, int height, int cubeSize = 3);
 
     /**
      * Destructor for Window. Release resources.
@@ -86,9 +88,46 @@ class Window {
     GLfloat mouseSensitivity;
 
     Scene scene;
+    SolverWorker solver;
+    unsigned int solveRequest; // The solve being waited for, 0 if none
+    bool showingTransformUpdates;        // Whether the title shows the matrices recomputed per frame
+    unsigned long shownTransformUpdates; // The count the title shows
 
     void handleKeyPressed(SDL_Keycode value);
 
+    /**
+     * Start solving the cube from the state it will be in once its queued moves are played.
+     * Only a 3x3x3 cube can be solved.
+     */
+    void startSolve();
+
+    /**
+     * Stop waiting for a solve, e.g. because the cube has been turned since it started.
+     */
+    void cancelSolve();
+
+    /**
+     * Handle the messages from the solver: show its progress in the title and play a solution.
+     */
+    void handleSolverMessages();
+
+    /**
+     * Show the number of matrices recomputed in the last frame in the title, or stop showing it.
+     */
+    void toggleTransformUpdates();
+
+    void showTransformUpdates();
+
+    /**
+     * Put the cube's state on the clipboard as a facelet string.
+     */
+    void copyState();
+
+    /**
+     * Set the cube to the facelet string on the clipboard, if it is a solvable 3x3x3 state.
+     */
+    void pasteState();
+
     void handleKeyReleased(SDL_Keycode value);
 };
 
@@ -0,0 +1,95 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Fixed set of worker threads that run batches of tasks. A batch is dealt out in contiguous
+ * blocks, one to each worker's own queue. A worker takes tasks from the front of its queue and,
+ * once that is empty, steals from the back of the other workers' queues, so uneven tasks are
+ * balanced without a single shared queue.
+ *
+ * @author mdq3
+ */
+
+#ifndef WORKSTEALINGPOOL_H_
+#define WORKSTEALINGPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *
+ */
+class WorkStealingPool {
+ public:
+    /**
+     * A task, given the index of the worker running it.
+     */
+    typedef std::function<void(int worker)> Task;
+
+    /**
+     * Constructor for WorkStealingPool.
+     *
+     * @param threads The number of worker threads
+     */
+    explicit WorkStealingPool(int threads);
+
+    /**
+     * Destructor for WorkStealingPool. Stops and joins the workers.
+     */
+    ~WorkStealingPool();
+
+    /**
+     * Run a batch of tasks on the workers and wait for all of them to finish.
+     *
+     * @param tasks The tasks to run
+     */
+    void run(std::vector<Task>& tasks);
+
+    int getThreadCount() const;
+
+ private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues; // One per worker
+    std::mutex mutex;
+    std::condition_variable wake;               // Signals a new batch or quit
+    std::condition_variable done;               // Signals the end of a batch
+    unsigned int batch;                         // Number of batches started
+    size_t pending;                             // Tasks of the current batch not yet finished
+    bool quit;
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void work(int worker);
+
+    bool next(int worker, Task& task);
+};
+
+#endif // WORKSTEALINGPOOL_H_
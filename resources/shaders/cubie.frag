@@ -0,0 +1,98 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#version 330 core
+
+// Camera, light and shadow transforms come from the Frame block in frame.glsl
+
+uniform sampler2DShadow shadowMap;
+
+uniform float materialShininess;
+
+// Sticker colours of the faces U, R, F, D, L, B, then the plastic
+const vec3 palette[7] = vec3[7](
+    vec3(1.0, 1.0, 1.0),
+    vec3(0.8, 0.0, 0.0),
+    vec3(0.0, 0.6, 0.2),
+    vec3(1.0, 0.85, 0.0),
+    vec3(1.0, 0.45, 0.0),
+    vec3(0.0, 0.25, 0.75),
+    vec3(0.05, 0.05, 0.05));
+
+in vec3 fragVert;
+in vec3 fragNormal;
+flat in uint fragColour;
+in vec4 shadowCoord;
+
+out vec4 color;
+
+void main()
+{
+    vec3 normal = normalize(fragNormal);
+
+    // Surface attributes
+    vec3 surfacePosition = fragVert;
+    vec3 surfaceColor    = palette[fragColour];
+    vec3 surfaceToCamera = normalize(cameraPosition - surfacePosition);
+    vec3 surfaceToLight  = light.direction;
+    if(light.isPoint)
+    {
+        surfaceToLight = normalize(light.position - surfacePosition);
+    }
+
+    // Ambient component
+    vec3 ambient = ambientLight * surfaceColor * light.rgb;
+
+    // Diffuse component
+    float diffuse = max(0.0, dot(normal, surfaceToLight));
+
+    // Specular component
+    float specular = 0.0;
+    if(diffuse > 0.0 && materialShininess > 0.0)
+    {
+        vec3 incidenceVector  = -surfaceToLight;
+        vec3 reflectionVector = reflect(incidenceVector, normal);
+        float cosAngle        = max(0.0, dot(surfaceToCamera, reflectionVector));
+        specular              = pow(cosAngle, materialShininess);
+    }
+
+    // Light attenuation
+    float distanceToLight = length(light.position - surfacePosition);
+    float attenuation     = 1.0 / (1.0 + light.attenuation * pow(distanceToLight, 2.0));
+
+    // Shadow
+    float sum = 0;
+    sum += textureProjOffset(shadowMap, shadowCoord, ivec2(-1.0, -1.0));
+    sum += textureProjOffset(shadowMap, shadowCoord, ivec2(-1.0, 1.0));
+    sum += textureProjOffset(shadowMap, shadowCoord, ivec2(1.0, 1.0));
+    sum += textureProjOffset(shadowMap, shadowCoord, ivec2(1.0, -1.0));
+    float shadow = sum * 0.25;
+
+    if(shadow == 0.0)
+    {
+        specular = 0.0;
+    }
+
+    // Linear color
+    vec3 scatteredLight = ambient + light.rgb * diffuse * shadow;
+    vec3 reflectedLight = light.rgb * specular * attenuation;
+
+    color = vec4(min(surfaceColor * scatteredLight + reflectedLight, vec3(1.0)), 1.0);
+}
@@ -0,0 +1,51 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#version 330 core
+
+// Camera, light and shadow transforms come from the Frame block in frame.glsl
+
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexNormal;
+layout (location = 2) in uint vertexFace;
+layout (location = 3) in mat4 instanceTransform;
+layout (location = 7) in uint instanceColours;
+
+out vec3 fragVert;
+out vec3 fragNormal;
+flat out uint fragColour;
+out vec4 shadowCoord;
+
+void main()
+{
+    vec4 worldPosition = instanceTransform * vec4(vertexPosition, 1.0);
+    fragVert   = vec3(worldPosition);
+    fragNormal = mat3(instanceTransform) * vertexNormal; // Rotation and translation only
+
+    // Faces inside the puzzle are plastic, as are the bevels
+    fragColour = 6u;
+    if(vertexFace < 6u)
+    {
+        fragColour = (instanceColours >> (3u * vertexFace)) & 7u;
+    }
+
+    gl_Position = viewProjectionMatrix * worldPosition;
+    shadowCoord = depthBiasMVP * worldPosition;
+}
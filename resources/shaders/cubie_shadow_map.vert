@@ -17,14 +17,15 @@
   along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+
 #version 330 core
 
-layout (location = 0) in vec3 vertexPosition;
+// Camera, light and shadow transforms come from the Frame block in frame.glsl
 
-uniform mat4 shadowViewProjectionMatrix;
-uniform mat4 modelMatrix;
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 3) in mat4 instanceTransform;
 
 void main()
 {
-    gl_Position = (shadowViewProjectionMatrix * modelMatrix) * vec4(vertexPosition, 1.0);
-}
\ No newline at end of file
+    gl_Position = shadowViewProjectionMatrix * instanceTransform * vec4(vertexPosition, 1.0);
+}
@@ -0,0 +1,41 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Per-frame data shared by every shader, inserted after the #version line of each one. The
+// layout is mirrored by FrameUniforms::Block.
+
+struct Light
+{
+    vec3 position;
+    vec3 rgb;
+    float attenuation;
+    vec3 direction;
+    bool isPoint;
+};
+
+layout (std140) uniform Frame
+{
+    mat4 viewProjectionMatrix;
+    mat4 shadowViewProjectionMatrix;
+    mat4 depthBiasMVP;
+    Light light;
+    float ambientLight;
+    vec3 cameraPosition;
+};
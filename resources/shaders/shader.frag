@@ -19,18 +19,9 @@
 
 #version 330 core
 
-uniform struct Light
-{
-    vec3 position;
-    vec3 rgb;
-    float attenuation;
-    vec3 direction;
-    bool isPoint;
-} light;
-
-uniform float ambientLight;
+// Camera, light and shadow transforms come from the Frame block in frame.glsl
 
-uniform sampler2D textureSampler;
+uniform sampler2DArray textureSampler;
 uniform sampler2DShadow shadowMap;
 
 uniform float materialShininess;
@@ -38,11 +29,10 @@ uniform vec3  materialSpecularColor;
 
 uniform mat4 modelTransformMatrix;
 uniform mat3 normalMatrix;
-uniform vec3 cameraPosition;
 
 in vec3 fragVert;
 in vec3 fragNormal;
-in vec2 fragUV;
+in vec3 fragUV;
 in vec4 shadowCoord;
 
 out vec4 color;
@@ -53,7 +43,7 @@ void main()
 
     // Surface attributes
     vec3 surfacePosition = vec3(modelTransformMatrix * vec4(fragVert, 1.0));
-    vec4 surfaceColor    = texture2D(textureSampler, fragUV);
+    vec4 surfaceColor    = texture(textureSampler, fragUV);
     vec3 surfaceToCamera = normalize(cameraPosition - surfacePosition);
     vec3 surfaceToLight  = light.direction;
     if(light.isPoint)
@@ -19,17 +19,18 @@
 
 #version 330 core
 
+// Camera, light and shadow transforms come from the Frame block in frame.glsl
+
 layout (location = 0) in vec3 vertexPosition;
 layout (location = 1) in vec3 vertexNormal;
-layout (location = 2) in vec2 vertexUV;
+layout (location = 2) in vec3 vertexUV; // Texture coordinates and texture array layer
 
 uniform mat4 modelTransformMatrix;
 uniform mat4 modelViewProjectionMatrix;
-uniform mat4 depthBiasMVP;
 
 out vec3 fragVert;
 out vec3 fragNormal;
-out vec2 fragUV;
+out vec3 fragUV;
 out vec4 shadowCoord;
 
 void main()
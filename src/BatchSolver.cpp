@@ -0,0 +1,206 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "../include/BatchSolver.hpp"
+#include "../include/CubeState.hpp"
+#include "../include/Facelets.hpp"
+
+BatchSolver::BatchSolver(Method method, int threads, int window, int maxLength, SolutionCache* cache) :
+method{method},
+threads{threads},
+maxLength{maxLength},
+cache{cache},
+read{0},
+written{0},
+solved{0},
+endOfInput{false}
+{
+    if(this->threads < 1)
+    {
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    slots.resize(std::max(window, this->threads));
+}
+
+BatchSolver::~BatchSolver() {}
+
+uint64_t BatchSolver::run(std::istream& input, std::ostream& output)
+{
+    read = 0;
+    written = 0;
+    solved = 0;
+    endOfInput = false;
+
+    std::vector<std::thread> workers;
+    for(int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(&BatchSolver::work, this);
+    }
+    std::thread writer(&BatchSolver::write, this, std::ref(output));
+
+    std::string line;
+    while(std::getline(input, line))
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFree.wait(lock, [this]() { return read - written < slots.size(); });
+        Slot& slot = slots[read % slots.size()];
+        slot.line.swap(line);
+        slot.done = false;
+        queue.push_back(read++);
+        lineQueued.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        endOfInput = true;
+    }
+    lineQueued.notify_all();
+    resultReady.notify_all();
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    writer.join();
+    output.flush();
+    return solved;
+}
+
+int BatchSolver::getThreadCount() const
+{
+    return threads;
+}
+
+uint64_t BatchSolver::getLineCount() const
+{
+    return read;
+}
+
+void BatchSolver::work()
+{
+    // Each thread needs its own solver, as a solver holds its search stack
+    std::unique_ptr<TwoPhaseSolver> twoPhase;
+    std::unique_ptr<OptimalSolver> optimal;
+    if(method == TWO_PHASE)
+    {
+        twoPhase.reset(new TwoPhaseSolver());
+        twoPhase->setCache(cache);
+    }
+    else
+    {
+        optimal.reset(new OptimalSolver(1));
+        optimal->setCache(cache);
+    }
+
+    std::string line;
+    while(true)
+    {
+        uint64_t number;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            lineQueued.wait(lock, [this]() { return !queue.empty() || endOfInput; });
+            if(queue.empty())
+            {
+                return;
+            }
+            number = queue.front();
+            queue.pop_front();
+            line = slots[number % slots.size()].line;
+        }
+
+        bool success = false;
+        std::string result = solveLine(line, twoPhase.get(), optimal.get(), success);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot& slot = slots[number % slots.size()];
+        slot.result.swap(result);
+        slot.done = true;
+        solved += success;
+        if(number == written)
+        {
+            resultReady.notify_one();
+        }
+    }
+}
+
+void BatchSolver::write(std::ostream& output)
+{
+    std::string result;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            resultReady.wait(lock, [this]()
+            {
+                return (written < read && slots[written % slots.size()].done) || (endOfInput && written == read);
+            });
+            if(written == read)
+            {
+                return;
+            }
+            result.swap(slots[written % slots.size()].result);
+            ++written;
+        }
+        slotFree.notify_one();
+        output << result << '\n';
+    }
+}
+
+std::string BatchSolver::solveLine(const std::string& line, TwoPhaseSolver* twoPhase, OptimalSolver* optimal,
+                                   bool& success)
+{
+    size_t begin = line.find_first_not_of(" \t\r");
+    size_t end = line.find_last_not_of(" \t\r");
+    std::string text = begin == std::string::npos ? "" : line.substr(begin, end - begin + 1);
+
+    // A 54-character line without spaces is a facelet string; nobody writes 54 moves that way
+    CubeState state;
+    std::vector<int> moves;
+    if(text.size() == Facelets::N_FACELETS && text.find_first_of(" \t") == std::string::npos)
+    {
+        if(!Facelets::toState(text, state))
+        {
+            return "error: invalid facelet string";
+        }
+    }
+    else if(CubeState::parseMoves(text, moves))
+    {
+        state.apply(moves);
+    }
+    else
+    {
+        return "error: not a move sequence or facelet string";
+    }
+    if(!state.isSolvable())
+    {
+        return "error: unsolvable position";
+    }
+
+    bool found = twoPhase != nullptr ? twoPhase->solve(state, moves, maxLength)
+                                     : optimal->solve(state, moves, maxLength);
+    if(!found)
+    {
+        return "error: no solution within " + std::to_string(maxLength) + " moves";
+    }
+    success = true;
+    return CubeState::formatMoves(moves);
+}
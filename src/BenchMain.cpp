@@ -0,0 +1,832 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Benchmarks of the solver engine, built as bin/cub3r-bench. Links no SDL or GL.
+ *
+ * Usage: cub3r-bench <benchmark> [options]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include "../include/BreadthFirstSearch.hpp"
+#include "../include/Coordinates.hpp"
+#include "../include/CubeState.hpp"
+#include "../include/Facelets.hpp"
+#include "../include/NxNCubeState.hpp"
+#include "../include/OptimalSolver.hpp"
+#include "../include/Scrambler.hpp"
+#include "../include/SimdCubeState.hpp"
+#include "../include/TwoPhaseSolver.hpp"
+
+namespace {
+
+/**
+ * Get the value of an integer option given as "--name value", or a default.
+ */
+int intOption(int argc, char** argv, const char* name, int value)
+{
+    for(int i = 2; i + 1 < argc; ++i)
+    {
+        if(strcmp(argv[i], name) == 0)
+        {
+            return atoi(argv[i + 1]);
+        }
+    }
+    return value;
+}
+
+/**
+ * Get the value of a string option given as "--name value", or a default.
+ */
+const char* stringOption(int argc, char** argv, const char* name, const char* value)
+{
+    for(int i = 2; i + 1 < argc; ++i)
+    {
+        if(strcmp(argv[i], name) == 0)
+        {
+            return argv[i + 1];
+        }
+    }
+    return value;
+}
+
+/**
+ * Random sequence of moves, never turning the same face twice in a row.
+ */
+CubeState scramble(std::mt19937& random, int length)
+{
+    CubeState state;
+    int previousFace = -1;
+    for(int i = 0; i < length; ++i)
+    {
+        int move;
+        do
+        {
+            move = random() % CubeState::N_MOVES;
+        } while(CubeState::moveFace(move) == previousFace);
+        state.apply(move);
+        previousFace = CubeState::moveFace(move);
+    }
+    return state;
+}
+
+/**
+ * Optimal solves of the same positions with 1, 2, 4, ... threads. Reports the speedup and
+ * scaling efficiency (speedup / threads) of each thread count against one thread.
+ */
+int benchScaling(int argc, char** argv)
+{
+    int positions = intOption(argc, argv, "--positions", 10);
+    int length = intOption(argc, argv, "--length", 14);
+    int splitDepth = intOption(argc, argv, "--split", 3);
+    int maxThreads = intOption(argc, argv, "--threads", std::max(1u, std::thread::hardware_concurrency()));
+    std::mt19937 random(intOption(argc, argv, "--seed", 1));
+
+    std::cout << "Loading tables... " << std::flush;
+    std::cout << OptimalSolver::initTables() << " s\n";
+
+    std::vector<CubeState> states;
+    for(int i = 0; i < positions; ++i)
+    {
+        states.push_back(scramble(random, length));
+    }
+
+    std::vector<int> threadCounts;
+    for(int threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::cout << positions << " positions, " << length << " move scrambles, split depth " << splitDepth << "\n\n";
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "seconds" << std::setw(16) << "nodes"
+              << std::setw(12) << "Mnodes/s" << std::setw(10) << "speedup" << std::setw(12) << "efficiency\n";
+
+    double baseline = 0.0;
+    for(int threads : threadCounts)
+    {
+        OptimalSolver solver(threads, splitDepth);
+        double seconds = 0.0;
+        uint64_t nodes = 0;
+        std::vector<int> solution;
+        for(const CubeState& state : states)
+        {
+            if(!solver.solve(state, solution))
+            {
+                std::cout << "Error: no solution found\n";
+                return 1;
+            }
+            seconds += solver.getElapsedSeconds();
+            nodes += solver.getNodeCount();
+        }
+        if(threads == 1)
+        {
+            baseline = seconds;
+        }
+
+        double speedup = seconds > 0.0 ? baseline / seconds : 0.0;
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(8) << threads << std::setw(12) << seconds << std::setw(16) << nodes
+                  << std::setw(12) << (seconds > 0.0 ? nodes / seconds / 1e6 : 0.0)
+                  << std::setw(10) << speedup << std::setw(11) << speedup / threads << '\n';
+    }
+    return 0;
+}
+
+/**
+ * Time a function applying a number of moves and print its rate.
+ */
+template <typename Apply>
+void timeMoves(const char* name, uint64_t count, Apply apply)
+{
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t check = apply();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << seconds * 1e9 / count << " ns/move" << std::setw(12) << count / seconds / 1e6
+              << " Mmoves/s   (" << std::hex << (check & 0xFFFF) << std::dec << ")\n";
+}
+
+/**
+ * Move application rate of the table-driven CubeState against each code path of
+ * SimdCubeState. Each state is turned by a long chain of random moves, so every move depends
+ * on the one before.
+ */
+int benchMoves(int argc, char** argv)
+{
+    uint64_t count = (uint64_t)intOption(argc, argv, "--moves", 100) * 1000000;
+    std::mt19937 random(intOption(argc, argv, "--seed", 1));
+    std::vector<int> moves(1 << 16);
+    for(int& move : moves)
+    {
+        move = random() % CubeState::N_MOVES;
+    }
+    uint64_t batches = count / moves.size();
+    count = batches * moves.size();
+
+    timeMoves("CubeState (move tables)", count, [&]()
+    {
+        CubeState state;
+        for(uint64_t b = 0; b < batches; ++b)
+        {
+            for(int move : moves)
+            {
+                state.apply(move);
+            }
+        }
+        return state.getCornerWord() ^ state.getEdgeWord();
+    });
+
+    SimdCubeState::Level supported = SimdCubeState::getSupportedLevel();
+    for(int level = SimdCubeState::SCALAR; level <= supported; ++level)
+    {
+        SimdCubeState::setLevel((SimdCubeState::Level)level);
+        std::string name = std::string("SimdCubeState ") + SimdCubeState::levelName((SimdCubeState::Level)level);
+        timeMoves((name + ", one move").c_str(), count, [&]()
+        {
+            SimdCubeState state;
+            for(uint64_t b = 0; b < batches; ++b)
+            {
+                for(int move : moves)
+                {
+                    state.apply(move);
+                }
+            }
+            return (uint64_t)state.toCubeState().getCornerWord() ^ state.toCubeState().getEdgeWord();
+        });
+        timeMoves((name + ", sequence").c_str(), count, [&]()
+        {
+            SimdCubeState state;
+            for(uint64_t b = 0; b < batches; ++b)
+            {
+                state.apply(moves);
+            }
+            return (uint64_t)state.toCubeState().getCornerWord() ^ state.toCubeState().getEdgeWord();
+        });
+    }
+    SimdCubeState::setLevel(supported);
+    return 0;
+}
+
+/**
+ * Facelet string parsing and validation rates on uniform random states, a quarter of them
+ * made invalid by swapping two facelets, as external input might be.
+ */
+int benchFacelets(int argc, char** argv)
+{
+    uint64_t count = (uint64_t)intOption(argc, argv, "--strings", 20) * 1000000;
+    std::mt19937 random(intOption(argc, argv, "--seed", 1));
+    Scrambler scrambler(random());
+    std::vector<std::string> strings(1 << 12);
+    for(size_t i = 0; i < strings.size(); ++i)
+    {
+        strings[i] = Facelets::fromState(scrambler.next());
+        if(i % 4 == 0)
+        {
+            std::swap(strings[i][random() % Facelets::N_FACELETS], strings[i][random() % Facelets::N_FACELETS]);
+        }
+    }
+    std::vector<CubeState> states(strings.size());
+    uint64_t batches = count / strings.size();
+    count = batches * strings.size();
+
+    auto time = [count](const char* name, uint64_t valid, double seconds)
+    {
+        std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(8) << seconds * 1e9 / count << " ns" << std::setw(10) << count / seconds / 1e6
+                  << " M/s   " << valid << " valid\n";
+    };
+    uint64_t valid = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for(uint64_t b = 0; b < batches; ++b)
+    {
+        for(size_t i = 0; i < strings.size(); ++i)
+        {
+            valid += Facelets::toState(strings[i], states[i]);
+        }
+    }
+    time("Facelets::toState", valid, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+
+    valid = 0;
+    begin = std::chrono::steady_clock::now();
+    for(uint64_t b = 0; b < batches; ++b)
+    {
+        for(const CubeState& state : states)
+        {
+            valid += state.isSolvable();
+        }
+    }
+    time("CubeState::isSolvable", valid, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+
+    valid = 0;
+    begin = std::chrono::steady_clock::now();
+    for(uint64_t b = 0; b < batches; ++b)
+    {
+        for(const std::string& string : strings)
+        {
+            CubeState state;
+            valid += Facelets::toState(string, state) && state.isSolvable();
+        }
+    }
+    time("both", valid, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    return 0;
+}
+
+/**
+ * Random state generation rate with one Scrambler per thread, and the rate of scramble
+ * sequences on one thread.
+ */
+int benchScrambler(int argc, char** argv)
+{
+    uint64_t count = (uint64_t)intOption(argc, argv, "--states", 10) * 1000000;
+    int threads = intOption(argc, argv, "--threads", std::max(1u, std::thread::hardware_concurrency()));
+    uint64_t seed = intOption(argc, argv, "--seed", 1);
+    int sequences = intOption(argc, argv, "--sequences", 100);
+
+    std::vector<uint64_t> unsolvable(threads, 0);
+    std::vector<std::thread> workers;
+    auto begin = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&unsolvable, count, threads, seed, t]()
+        {
+            Scrambler scrambler(seed, t);
+            for(uint64_t i = t; i < count; i += threads)
+            {
+                unsolvable[t] += !scrambler.next().isSolvable();
+            }
+        });
+    }
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    uint64_t failed = 0;
+    for(uint64_t n : unsolvable)
+    {
+        failed += n;
+    }
+    std::cout << count << " states on " << threads << " threads in " << std::fixed << std::setprecision(3)
+              << seconds << " s: " << count / seconds / 1e6 << " Mstates/s, " << failed << " unsolvable\n";
+
+    if(sequences > 0)
+    {
+        Scrambler scrambler(seed);
+        std::vector<int> scramble;
+        scrambler.next(scramble); // Loads the tables
+        uint64_t moves = 0;
+        begin = std::chrono::steady_clock::now();
+        for(int i = 0; i < sequences; ++i)
+        {
+            scrambler.next(scramble);
+            moves += scramble.size();
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << sequences << " scramble sequences in " << seconds << " s: " << sequences / seconds
+                  << " per second, " << (double)moves / sequences << " moves on average\n";
+    }
+    return 0;
+}
+
+/**
+ * Time random turns of one kind of layer on an NxNCubeState for at least a number of seconds.
+ * Returns the microseconds per turn.
+ */
+template <typename Layer>
+double timeTurns(NxNCubeState& state, std::mt19937& random, double minimum, Layer layer)
+{
+    const int batch = 64;
+    uint64_t turns = 0;
+    double seconds = 0;
+    auto begin = std::chrono::steady_clock::now();
+    while(seconds < minimum)
+    {
+        for(int i = 0; i < batch; ++i)
+        {
+            state.turn(random() % CubeState::N_FACES, layer(), random() % 3 + 1);
+        }
+        turns += batch;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    return seconds * 1e6 / turns;
+}
+
+/**
+ * Turn rate of NxNCubeState for sizes from 2 up, doubling, and 1000: inner slice turns, which
+ * only cycle strips, and outer turns, which also rotate a face.
+ */
+int benchNxN(int argc, char** argv)
+{
+    int maximum = intOption(argc, argv, "--max", 2048);
+    double minimum = intOption(argc, argv, "--ms", 200) / 1000.0;
+    std::mt19937 random(intOption(argc, argv, "--seed", 1));
+
+    std::vector<int> sizes = {2, 3};
+    for(int n = 4; n <= maximum; n *= 2)
+    {
+        sizes.push_back(n);
+    }
+    if(maximum >= 1000)
+    {
+        sizes.push_back(1000);
+        std::sort(sizes.begin(), sizes.end());
+    }
+
+    std::cout << std::setw(6) << "N" << std::setw(16) << "slice us/turn" << std::setw(16) << "outer us/turn"
+              << std::setw(12) << "MB" << "\n" << std::fixed;
+    for(int n : sizes)
+    {
+        NxNCubeState state(n);
+        std::cout << std::setw(6) << n << std::setprecision(3);
+        if(n > 2)
+        {
+            std::cout << std::setw(16) << timeTurns(state, random, minimum, [&]()
+            {
+                return 1 + (int)(random() % (n - 2));
+            });
+        }
+        else
+        {
+            std::cout << std::setw(16) << "-";
+        }
+        std::cout << std::setw(16) << timeTurns(state, random, minimum, []()
+        {
+            return 0;
+        });
+        std::cout << std::setw(12) << std::setprecision(1) << CubeState::N_FACES * (double)n * n / 1e6
+                  << "\n";
+    }
+    return 0;
+}
+
+// Position of the four UD-slice edges, ignoring their order
+int getSlice(const CubeState& state)
+{
+    return Coordinates::getSliceSorted(state) / Coordinates::N_SLICE_PERM;
+}
+
+void setSlice(CubeState& state, int slice)
+{
+    Coordinates::setSliceSorted(state, slice * Coordinates::N_SLICE_PERM);
+}
+
+/**
+ * Exact distance distribution of a group of states, by breadth-first search. Reports the rate
+ * and peak memory, which make it a memory bandwidth benchmark as well.
+ */
+int benchDistribution(int argc, char** argv)
+{
+    typedef BreadthFirstSearch::Coordinate Coordinate;
+    const Coordinate cornerPerm = {Coordinates::N_CORNER_PERM, Coordinates::getCornerPermutation,
+                                   Coordinates::setCornerPermutation};
+    const Coordinate twist = {Coordinates::N_TWIST, Coordinates::getTwist, Coordinates::setTwist};
+    const Coordinate flip = {Coordinates::N_FLIP, Coordinates::getFlip, Coordinates::setFlip};
+    const Coordinate slice = {Coordinates::N_SLICE, getSlice, setSlice};
+    // Phase 2 moves keep the slice edges in the slice, so the sorted coordinate stays below 24
+    const Coordinate slicePerm = {Coordinates::N_SLICE_PERM, Coordinates::getSliceSorted,
+                                  Coordinates::setSliceSorted};
+    const Coordinate edgePerm = {Coordinates::N_UD_EDGE_PERM, Coordinates::getUDEdgePermutation,
+                                 Coordinates::setUDEdgePermutation};
+
+    std::vector<int> allMoves;
+    for(int m = 0; m < CubeState::N_MOVES; ++m)
+    {
+        allMoves.push_back(m);
+    }
+    const std::vector<int> phase2Moves = {0, 1, 2, 9, 10, 11, 4, 7, 13, 16};
+
+    std::string group = stringOption(argc, argv, "--group", "corners");
+    std::vector<Coordinate> coordinates;
+    std::vector<int> moves = allMoves;
+    if(group == "corners")
+    {
+        coordinates = {cornerPerm, twist};
+    }
+    else if(group == "phase1")
+    {
+        coordinates = {twist, flip, slice};
+    }
+    else if(group == "phase2-corners")
+    {
+        coordinates = {cornerPerm, slicePerm};
+        moves = phase2Moves;
+    }
+    else if(group == "phase2-edges")
+    {
+        coordinates = {edgePerm, slicePerm};
+        moves = phase2Moves;
+    }
+    else
+    {
+        std::cout << "Unknown group " << group << '\n';
+        return 1;
+    }
+
+    BreadthFirstSearch search(coordinates, moves, intOption(argc, argv, "--threads", 0));
+    std::cout << "Group " << group << ": " << search.getSize() << " states, " << (search.getSize() + 3) / 4
+              << " bytes at 2 bits each, " << search.getThreadCount() << " threads\n\n"
+              << "depth          states    seconds\n";
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<uint64_t> counts = search.run([](int depth, uint64_t count, double seconds)
+    {
+        std::cout << std::setw(5) << depth << std::setw(16) << count << std::setw(11) << std::fixed
+                  << std::setprecision(3) << seconds << std::endl;
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    uint64_t reached = 0;
+    for(uint64_t count : counts)
+    {
+        reached += count;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "\nReached " << reached << " of " << search.getSize() << " states in " << seconds << " s ("
+              << reached / seconds / 1e6 << " Mstates/s), peak RSS " << usage.ru_maxrss / 1024 << " MB\n";
+    return 0;
+}
+
+/**
+ * A position of the benchmark corpus.
+ */
+struct CorpusEntry
+{
+    std::string group;
+    CubeState state;
+    int length; // Scramble length, an upper bound on the distance, or 0 if the group has none
+};
+
+/**
+ * Read a corpus file: one position per line as a group name and a scramble, skipping blank
+ * lines and lines starting '#'. A numbered group's scrambles are that many moves long.
+ */
+bool readCorpus(const char* path, std::vector<CorpusEntry>& corpus)
+{
+    std::ifstream file(path);
+    if(!file)
+    {
+        std::cerr << "Error: could not open " << path << '\n';
+        return false;
+    }
+    std::string line;
+    for(int number = 1; std::getline(file, line); ++number)
+    {
+        if(line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        size_t split = line.find(' ');
+        std::vector<int> moves;
+        if(split == std::string::npos || !CubeState::parseMoves(line.substr(split + 1), moves))
+        {
+            std::cerr << "Error: " << path << " line " << number << " is not a group and a scramble\n";
+            return false;
+        }
+        CorpusEntry entry = {line.substr(0, split), CubeState(), atoi(line.c_str())};
+        entry.state.apply(moves);
+        corpus.push_back(entry);
+    }
+    return true;
+}
+
+/**
+ * Latency of a percentile of sorted latencies, by nearest rank.
+ */
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+    size_t rank = (size_t)std::ceil(fraction * sorted.size());
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+/**
+ * Write the median, 99th percentile and maximum of some latencies in seconds as JSON members
+ * in milliseconds.
+ */
+void writeLatencies(std::ostream& out, std::vector<double> latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    out << "\"median_ms\": " << percentile(latencies, 0.5) * 1e3
+        << ", \"p99_ms\": " << percentile(latencies, 0.99) * 1e3
+        << ", \"max_ms\": " << latencies.back() * 1e3;
+}
+
+/**
+ * Results of solving the corpus once.
+ */
+struct SuiteRun
+{
+    std::vector<double> latencies; // Seconds per position, in corpus order
+    std::vector<int> lengths;      // Solution length per position, -1 if it was not solved
+    uint64_t nodes;
+    double seconds;                // Wall time of the whole run
+};
+
+/**
+ * Solve positions with one two-phase solver per thread, each taking the next unsolved position.
+ */
+SuiteRun runTwoPhase(const std::vector<CorpusEntry>& corpus, int threads)
+{
+    SuiteRun run = {std::vector<double>(corpus.size()), std::vector<int>(corpus.size()), 0, 0.0};
+    std::atomic<size_t> next(0);
+    std::atomic<uint64_t> nodes(0);
+    std::vector<std::thread> workers;
+    auto begin = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&corpus, &run, &next, &nodes]()
+        {
+            TwoPhaseSolver solver;
+            std::vector<int> solution;
+            for(size_t i = next++; i < corpus.size(); i = next++)
+            {
+                auto start = std::chrono::steady_clock::now();
+                bool solved = solver.solve(corpus[i].state, solution);
+                run.latencies[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                CubeState state = corpus[i].state;
+                state.apply(solution);
+                run.lengths[i] = solved && state.isSolved() ? (int)solution.size() : -1;
+                nodes += solver.getNodeCount();
+            }
+        });
+    }
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    run.nodes = nodes;
+    return run;
+}
+
+/**
+ * Solve positions one at a time with an optimal solver searching on a number of threads. A
+ * solution longer than its scramble does not count as solved.
+ */
+SuiteRun runOptimal(const std::vector<CorpusEntry>& corpus, int threads)
+{
+    SuiteRun run = {std::vector<double>(corpus.size()), std::vector<int>(corpus.size()), 0, 0.0};
+    OptimalSolver solver(threads);
+    std::vector<int> solution;
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < corpus.size(); ++i)
+    {
+        bool solved = solver.solve(corpus[i].state, solution);
+        run.latencies[i] = solver.getElapsedSeconds();
+        run.nodes += solver.getNodeCount();
+        CubeState state = corpus[i].state;
+        state.apply(solution);
+        bool optimal = corpus[i].length == 0 || (int)solution.size() <= corpus[i].length;
+        run.lengths[i] = solved && state.isSolved() && optimal ? (int)solution.size() : -1;
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return run;
+}
+
+/**
+ * Write a run as a JSON object, with the latencies of each group of the corpus. Counts the
+ * positions not solved and the runs over a p99 latency limit as failures.
+ */
+void writeRun(std::ostream& out, const std::vector<CorpusEntry>& corpus, int threads, const SuiteRun& run,
+              double maxP99, int& failures)
+{
+    int unsolved = std::count(run.lengths.begin(), run.lengths.end(), -1);
+    double moves = 0.0;
+    for(int length : run.lengths)
+    {
+        moves += std::max(length, 0);
+    }
+    std::vector<double> sorted = run.latencies;
+    std::sort(sorted.begin(), sorted.end());
+    failures += unsolved + (maxP99 > 0.0 && percentile(sorted, 0.99) * 1e3 > maxP99);
+
+    out << "        {\"threads\": " << threads << ", \"positions\": " << corpus.size()
+        << ", \"unsolved\": " << unsolved << ", \"mean_length\": " << moves / corpus.size()
+        << ",\n         \"seconds\": " << run.seconds << ", \"nodes\": " << run.nodes
+        << ", \"nodes_per_second\": " << (run.seconds > 0.0 ? run.nodes / run.seconds : 0.0)
+        << ",\n         ";
+    writeLatencies(out, run.latencies);
+    out << ",\n         \"groups\": [";
+
+    std::vector<std::string> groups;
+    for(const CorpusEntry& entry : corpus)
+    {
+        if(std::find(groups.begin(), groups.end(), entry.group) == groups.end())
+        {
+            groups.push_back(entry.group);
+        }
+    }
+    for(size_t g = 0; g < groups.size(); ++g)
+    {
+        std::vector<double> latencies;
+        for(size_t i = 0; i < corpus.size(); ++i)
+        {
+            if(corpus[i].group == groups[g])
+            {
+                latencies.push_back(run.latencies[i]);
+            }
+        }
+        out << (g == 0 ? "\n" : ",\n") << "           {\"group\": \"" << groups[g] << "\", \"positions\": "
+            << latencies.size() << ", ";
+        writeLatencies(out, latencies);
+        out << '}';
+    }
+    out << "]}";
+}
+
+/**
+ * Solve a fixed corpus with each solver and thread count, writing JSON to diff between builds:
+ * table load time, peak memory, and per run the latency median and 99th percentile overall and
+ * per group, and the node rate. The two-phase solver runs one solver per thread; the optimal
+ * solver solves one position at a time on all the threads, only the groups of short scrambles.
+ * Exits with 1 if any position is not solved, or not optimally, or a p99 is over --max-p99.
+ */
+int benchSuite(int argc, char** argv)
+{
+    const char* path = stringOption(argc, argv, "--corpus", "resources/bench/scrambles.txt");
+    int maxThreads = intOption(argc, argv, "--threads", std::max(1u, std::thread::hardware_concurrency()));
+    int optimalLength = intOption(argc, argv, "--optimal-length", 12);
+    double maxP99 = intOption(argc, argv, "--max-p99", 0);
+
+    std::vector<CorpusEntry> corpus;
+    if(!readCorpus(path, corpus) || corpus.empty())
+    {
+        return 1;
+    }
+    std::vector<CorpusEntry> shortCorpus;
+    for(const CorpusEntry& entry : corpus)
+    {
+        if(entry.length > 0 && entry.length <= optimalLength)
+        {
+            shortCorpus.push_back(entry);
+        }
+    }
+    std::vector<int> threadCounts;
+    for(int threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::ostream& out = std::cout;
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"corpus\": \"" << path << "\", \"positions\": " << corpus.size()
+        << ", \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n  \"solvers\": [\n";
+
+    int failures = 0;
+    for(int s = 0; s < 2; ++s)
+    {
+        bool optimal = s == 1;
+        if(optimal && shortCorpus.empty())
+        {
+            break;
+        }
+        double load = optimal ? OptimalSolver::initTables() : TwoPhaseSolver::initTables();
+        out << (s == 0 ? "" : ",\n") << "    {\"solver\": \"" << (optimal ? "optimal" : "two-phase")
+            << "\", \"table_load_seconds\": " << load << ",\n      \"runs\": [\n";
+        for(size_t t = 0; t < threadCounts.size(); ++t)
+        {
+            SuiteRun run = optimal ? runOptimal(shortCorpus, threadCounts[t]) : runTwoPhase(corpus, threadCounts[t]);
+            writeRun(out, optimal ? shortCorpus : corpus, threadCounts[t], run, maxP99, failures);
+            out << (t + 1 < threadCounts.size() ? ",\n" : "\n");
+        }
+        // Peak RSS of the process, so the optimal solver's includes the two-phase tables
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        out << "      ],\n      \"peak_rss_mb\": " << usage.ru_maxrss / 1024.0 << "}";
+    }
+    out << "\n  ]\n}\n";
+    return failures == 0 ? 0 : 1;
+}
+
+void usage()
+{
+    std::cout << "Usage: cub3r-bench <benchmark> [options]\n\n"
+              << "  scaling   Optimal solver speedup per thread count\n"
+              << "            --positions N --length N --split N --threads N --seed N\n"
+              << "  moves     Move application rate of each state representation\n"
+              << "            --moves N (millions) --seed N\n"
+              << "  facelets  Facelet string parsing and validation rates\n"
+              << "            --strings N (millions) --seed N\n"
+              << "  scrambler Uniform random state generation rate\n"
+              << "            --states N (millions) --threads N --seed N --sequences N\n"
+              << "  nxn       NxNCubeState slice and outer turn times for N = 2 to 2048\n"
+              << "            --max N --ms N (per measurement) --seed N\n"
+              << "  distribution  Exact distance distribution of a group by breadth-first search\n"
+              << "            --group corners|phase1|phase2-corners|phase2-edges --threads N\n"
+              << "  suite     Solve latency, node rate, table load time and memory per solver and\n"
+              << "            thread count on a fixed corpus, as JSON\n"
+              << "            --corpus FILE --threads N --optimal-length N --max-p99 MS\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        usage();
+        return 1;
+    }
+
+    std::string benchmark = argv[1];
+    if(benchmark == "scaling")
+    {
+        return benchScaling(argc, argv);
+    }
+    if(benchmark == "moves")
+    {
+        return benchMoves(argc, argv);
+    }
+    if(benchmark == "facelets")
+    {
+        return benchFacelets(argc, argv);
+    }
+    if(benchmark == "scrambler")
+    {
+        return benchScrambler(argc, argv);
+    }
+    if(benchmark == "nxn")
+    {
+        return benchNxN(argc, argv);
+    }
+    if(benchmark == "distribution")
+    {
+        return benchDistribution(argc, argv);
+    }
+    if(benchmark == "suite")
+    {
+        return benchSuite(argc, argv);
+    }
+    usage();
+    return 1;
+}
@@ -0,0 +1,214 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "../include/BreadthFirstSearch.hpp"
+#include "../include/Coordinates.hpp"
+
+namespace {
+
+const int UNREACHED = 3;
+
+} // namespace
+
+BreadthFirstSearch::BreadthFirstSearch(const std::vector<Coordinate>& coordinates, const std::vector<int>& moves,
+                                       int threads) :
+coordinates(coordinates),
+moves(moves),
+size{1}
+{
+    for(const Coordinate& coordinate : coordinates)
+    {
+        moveTables.emplace_back();
+        Coordinates::buildMoveTable(moveTables.back(), coordinate.size, coordinate.get, coordinate.set,
+                                    moves.data(), (int)moves.size());
+        size *= coordinate.size;
+    }
+    if(threads < 1)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    pool.reset(new WorkStealingPool(threads));
+}
+
+BreadthFirstSearch::~BreadthFirstSearch() {}
+
+std::vector<uint64_t> BreadthFirstSearch::run(const Progress& progress)
+{
+    uint64_t wordCount = (size + 31) / 32;
+    words.reset(new std::atomic<uint64_t>[wordCount]);
+    for(uint64_t i = 0; i < wordCount; ++i)
+    {
+        words[i].store(~0ULL, std::memory_order_relaxed);
+    }
+
+    CubeState solved;
+    uint64_t start = 0;
+    for(const Coordinate& coordinate : coordinates)
+    {
+        start = start * coordinate.size + coordinate.get(solved);
+    }
+    reach(start, 0);
+
+    std::vector<uint64_t> counts(1, 1);
+    if(progress)
+    {
+        progress(0, 1, 0.0);
+    }
+    uint64_t visited = 1;
+    std::vector<uint64_t> found(pool->getThreadCount());
+    for(int depth = 0; ; ++depth)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        bool backward = counts[depth] > size - visited;
+        int current = depth % 3;
+        int next = (depth + 1) % 3;
+
+        std::fill(found.begin(), found.end(), 0);
+        std::vector<WorkStealingPool::Task> tasks;
+        for(uint64_t first = 0; first < size; first += CHUNK)
+        {
+            uint64_t last = std::min(size, first + CHUNK);
+            tasks.push_back([this, &found, first, last, backward, current, next](int worker)
+            {
+                found[worker] += backward ? expandBackward(first, last, current, next)
+                                          : expandForward(first, last, current, next);
+            });
+        }
+        pool->run(tasks);
+
+        uint64_t count = 0;
+        for(uint64_t n : found)
+        {
+            count += n;
+        }
+        if(count == 0)
+        {
+            break;
+        }
+        visited += count;
+        counts.push_back(count);
+        if(progress)
+        {
+            progress(depth + 1, count, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        }
+    }
+    words.reset();
+    return counts;
+}
+
+uint64_t BreadthFirstSearch::getSize() const
+{
+    return size;
+}
+
+int BreadthFirstSearch::getThreadCount() const
+{
+    return pool->getThreadCount();
+}
+
+int BreadthFirstSearch::get(uint64_t index) const
+{
+    return (words[index >> 5].load(std::memory_order_relaxed) >> ((index & 31) << 1)) & 3;
+}
+
+bool BreadthFirstSearch::reach(uint64_t index, int value)
+{
+    // Unreached is 11 in binary, so clearing the bits not set in the value sets it
+    int shift = (index & 31) << 1;
+    uint64_t old = words[index >> 5].fetch_and(~((uint64_t)(UNREACHED ^ value) << shift), std::memory_order_relaxed);
+    return ((old >> shift) & 3) == UNREACHED;
+}
+
+int BreadthFirstSearch::neighbours(uint64_t index, uint64_t* next) const
+{
+    int values[MAX_COORDINATES];
+    for(int c = (int)coordinates.size() - 1; c >= 0; --c)
+    {
+        values[c] = (int)(index % coordinates[c].size);
+        index /= coordinates[c].size;
+    }
+    for(size_t m = 0; m < moves.size(); ++m)
+    {
+        uint64_t neighbour = 0;
+        for(size_t c = 0; c < coordinates.size(); ++c)
+        {
+            neighbour = neighbour * coordinates[c].size + moveTables[c][values[c] * CubeState::N_MOVES + moves[m]];
+        }
+        next[m] = neighbour;
+    }
+    return (int)moves.size();
+}
+
+uint64_t BreadthFirstSearch::expandForward(uint64_t begin, uint64_t end, int current, int next)
+{
+    uint64_t found = 0;
+    uint64_t neighbour[CubeState::N_MOVES];
+    for(uint64_t i = begin; i < end; ++i)
+    {
+        // Skip words with nothing reached
+        if((i & 31) == 0 && words[i >> 5].load(std::memory_order_relaxed) == ~0ULL)
+        {
+            i += 31;
+            continue;
+        }
+        if(get(i) != current)
+        {
+            continue;
+        }
+        int count = neighbours(i, neighbour);
+        for(int k = 0; k < count; ++k)
+        {
+            if(get(neighbour[k]) == UNREACHED && reach(neighbour[k], next))
+            {
+                ++found;
+            }
+        }
+    }
+    return found;
+}
+
+uint64_t BreadthFirstSearch::expandBackward(uint64_t begin, uint64_t end, int current, int next)
+{
+    // A state not reached yet is at least one level past the frontier, so any neighbour of it
+    // on the frontier is exactly one level nearer. States reached by this level hold next, not
+    // current, so they are never mistaken for the frontier
+    uint64_t found = 0;
+    uint64_t neighbour[CubeState::N_MOVES];
+    for(uint64_t i = begin; i < end; ++i)
+    {
+        if(get(i) != UNREACHED)
+        {
+            continue;
+        }
+        int count = neighbours(i, neighbour);
+        for(int k = 0; k < count; ++k)
+        {
+            if(get(neighbour[k]) == current)
+            {
+                reach(i, next);
+                ++found;
+                break;
+            }
+        }
+    }
+    return found;
+}
@@ -31,6 +31,8 @@ center(glm::vec3(8.33f, 6.73f, 9.16f)),
 up(glm::vec3(0.0f, 1.0f, 0.0f)),
 direction(glm::vec3(-0.63f, -0.49f, -0.61f)),
 sideways(glm::vec3(-0.70f, 0.00f, 0.72f)),
+viewChanged{true},
+transformUpdates{0},
 currentSpeedX{0.0f}, currentSpeedY{0.0f}, currentSpeedZ{0.0f}
 {
     setProjectionPerspective(45.0f, (GLfloat)windowWidth / (GLfloat)windowHeight, 0.1f, 100.0f);
@@ -40,7 +42,8 @@ Camera::~Camera() {}
 
 glm::mat4 Camera::getViewMatrix()
 {
-    return glm::lookAt(eyePos, center, up);;
+    updateMatrices();
+    return viewMatrix;
 }
 
 glm::mat4 Camera::getProjectionMatrix()
@@ -50,7 +53,8 @@ glm::mat4 Camera::getProjectionMatrix()
 
 glm::mat4 Camera::getProjectionViewMatrix()
 {
-    return projectionMatrix * getViewMatrix();
+    updateMatrices();
+    return projectionViewMatrix;
 }
 
 glm::vec3 Camera::getPosition()
@@ -58,6 +62,11 @@ glm::vec3 Camera::getPosition()
     return eyePos;
 }
 
+unsigned long Camera::getTransformUpdates() const
+{
+    return transformUpdates;
+}
+
 void Camera::setSpeedX(GLfloat speed)
 {
     currentSpeedX = speed;
@@ -75,6 +84,11 @@ void Camera::setSpeedZ(GLfloat speed)
 
 void Camera::move()
 {
+    if(currentSpeedX == 0.0f && currentSpeedZ == 0.0f)
+    {
+        return;
+    }
+    viewChanged = true;
     eyePos += (direction * currentSpeedZ) + (sideways * currentSpeedX);
     center = eyePos + direction;
 }
@@ -82,12 +96,14 @@ void Camera::move()
 void Camera::setProjectionPerspective(GLfloat fov, GLfloat aspectRatio, GLfloat near, GLfloat far)
 {
     projectionMatrix = glm::perspective(fov, aspectRatio, near, far);
+    viewChanged = true;
 }
 
 void Camera::setProjectionOrthographic()
 {
     // Left, Right, Bottom, Top, zNear, zFar
     projectionMatrix = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f);
+    viewChanged = true;
 }
 
 void Camera::roll(GLfloat angle)
@@ -101,6 +117,7 @@ void Camera::pitch(GLfloat angle)
     {
         direction = glm::rotate(direction, angle, sideways);
         center = eyePos + direction;
+        viewChanged = true;
     }
 }
 
@@ -109,8 +126,20 @@ void Camera::yaw(GLfloat angle)
     direction = glm::rotate(direction, angle, glm::vec3(0.0f, 1.0f, 0.0f));
     sideways = glm::rotate(sideways, angle, glm::vec3(0.0f, 1.0f, 0.0f));
     center = eyePos + direction;
+    viewChanged = true;
 }
 
+void Camera::updateMatrices()
+{
+    if(!viewChanged)
+    {
+        return;
+    }
+    viewMatrix = glm::lookAt(eyePos, center, up);
+    projectionViewMatrix = projectionMatrix * viewMatrix;
+    viewChanged = false;
+    transformUpdates += 2;
+}
 
 void Camera::printInfo()
 {
@@ -0,0 +1,244 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../include/Coordinates.hpp"
+
+namespace {
+
+const int FIRST_SLICE_EDGE = 8; // FR, the first of the four UD-slice edges
+
+} // namespace
+
+int Coordinates::getTwist(const CubeState& state)
+{
+    int twist = 0;
+    for(int i = 0; i < CubeState::N_CORNERS - 1; ++i)
+    {
+        twist = twist * 3 + state.cornerOrientation(i);
+    }
+    return twist;
+}
+
+void Coordinates::setTwist(CubeState& state, int twist)
+{
+    int sum = 0;
+    for(int i = CubeState::N_CORNERS - 2; i >= 0; --i)
+    {
+        state.setCorner(i, state.cornerPermutation(i), twist % 3);
+        sum += twist % 3;
+        twist /= 3;
+    }
+    int last = CubeState::N_CORNERS - 1;
+    state.setCorner(last, state.cornerPermutation(last), (3 - sum % 3) % 3);
+}
+
+int Coordinates::getFlip(const CubeState& state)
+{
+    int flip = 0;
+    for(int i = 0; i < CubeState::N_EDGES - 1; ++i)
+    {
+        flip = flip * 2 + state.edgeOrientation(i);
+    }
+    return flip;
+}
+
+void Coordinates::setFlip(CubeState& state, int flip)
+{
+    int sum = 0;
+    for(int i = CubeState::N_EDGES - 2; i >= 0; --i)
+    {
+        state.setEdge(i, state.edgePermutation(i), flip % 2);
+        sum += flip % 2;
+        flip /= 2;
+    }
+    int last = CubeState::N_EDGES - 1;
+    state.setEdge(last, state.edgePermutation(last), sum % 2);
+}
+
+int Coordinates::getSliceSorted(const CubeState& state)
+{
+    // Combination of the slice edge positions, counted from the top so the solved state is 0
+    int combination = 0;
+    int found = 0;
+    int order[4];
+    for(int j = CubeState::N_EDGES - 1; j >= 0; --j)
+    {
+        int edge = state.edgePermutation(j);
+        if(edge >= FIRST_SLICE_EDGE)
+        {
+            combination += binomial(CubeState::N_EDGES - 1 - j, found + 1);
+            order[3 - found] = edge - FIRST_SLICE_EDGE;
+            ++found;
+        }
+    }
+    return combination * N_SLICE_PERM + rankPermutation(order, 4);
+}
+
+void Coordinates::setSliceSorted(CubeState& state, int sliceSorted)
+{
+    int combination = sliceSorted / N_SLICE_PERM;
+    int order[4];
+    unrankPermutation(sliceSorted % N_SLICE_PERM, order, 4);
+
+    int remaining = 4;
+    int nextOther = 0;
+    for(int j = 0; j < CubeState::N_EDGES; ++j)
+    {
+        int flip = state.edgeOrientation(j);
+        int c = binomial(CubeState::N_EDGES - 1 - j, remaining);
+        if(remaining > 0 && combination >= c)
+        {
+            combination -= c;
+            state.setEdge(j, FIRST_SLICE_EDGE + order[4 - remaining], flip);
+            --remaining;
+        }
+        else
+        {
+            state.setEdge(j, nextOther++, flip);
+        }
+    }
+}
+
+int Coordinates::getFlipSlice(const CubeState& state)
+{
+    return getSliceSorted(state) / N_SLICE_PERM * N_FLIP + getFlip(state);
+}
+
+void Coordinates::setFlipSlice(CubeState& state, int flipSlice)
+{
+    setSliceSorted(state, flipSlice / N_FLIP * N_SLICE_PERM);
+    setFlip(state, flipSlice % N_FLIP);
+}
+
+int Coordinates::getCornerPermutation(const CubeState& state)
+{
+    int permutation[CubeState::N_CORNERS];
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        permutation[i] = state.cornerPermutation(i);
+    }
+    return rankPermutation(permutation, CubeState::N_CORNERS);
+}
+
+void Coordinates::setCornerPermutation(CubeState& state, int rank)
+{
+    int permutation[CubeState::N_CORNERS];
+    unrankPermutation(rank, permutation, CubeState::N_CORNERS);
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        state.setCorner(i, permutation[i], state.cornerOrientation(i));
+    }
+}
+
+int Coordinates::getUDEdgePermutation(const CubeState& state)
+{
+    int permutation[8];
+    for(int i = 0; i < 8; ++i)
+    {
+        permutation[i] = state.edgePermutation(i);
+    }
+    return rankPermutation(permutation, 8);
+}
+
+void Coordinates::setUDEdgePermutation(CubeState& state, int rank)
+{
+    int permutation[8];
+    unrankPermutation(rank, permutation, 8);
+    for(int i = 0; i < 8; ++i)
+    {
+        state.setEdge(i, permutation[i], state.edgeOrientation(i));
+    }
+}
+
+void Coordinates::buildMoveTable(std::vector<uint16_t>& table, int size, int (*get)(const CubeState&),
+                                 void (*set)(CubeState&, int), const int* moves, int moveCount)
+{
+    table.assign(size * CubeState::N_MOVES, 0);
+    for(int i = 0; i < size; ++i)
+    {
+        CubeState state;
+        set(state, i);
+        for(int k = 0; k < moveCount; ++k)
+        {
+            CubeState next = state;
+            next.apply(moves[k]);
+            table[i * CubeState::N_MOVES + moves[k]] = (uint16_t)get(next);
+        }
+    }
+}
+
+int Coordinates::rankPermutation(const int* permutation, int n)
+{
+    // Lehmer code read as a factorial-base number
+    int rank = 0;
+    for(int i = 0; i < n; ++i)
+    {
+        int smaller = 0;
+        for(int j = i + 1; j < n; ++j)
+        {
+            if(permutation[j] < permutation[i])
+            {
+                ++smaller;
+            }
+        }
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+
+void Coordinates::unrankPermutation(int rank, int* permutation, int n)
+{
+    int digits[16];
+    for(int i = n - 1; i >= 0; --i)
+    {
+        digits[i] = rank % (n - i);
+        rank /= n - i;
+    }
+
+    bool used[16] = {false};
+    for(int i = 0; i < n; ++i)
+    {
+        int skip = digits[i];
+        int value = 0;
+        while(used[value] || skip > 0)
+        {
+            if(!used[value])
+            {
+                --skip;
+            }
+            ++value;
+        }
+        used[value] = true;
+        permutation[i] = value;
+    }
+}
+
+int Coordinates::binomial(int n, int k)
+{
+    if(k < 0 || k > n)
+    {
+        return 0;
+    }
+    int result = 1;
+    for(int i = 1; i <= k; ++i)
+    {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
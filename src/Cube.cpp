@@ -17,128 +17,297 @@
   along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <iostream>
-#include <cmath>
+#include <algorithm>
 #include "../include/Cube.hpp"
+#include "../include/Facelets.hpp"
+#include <glm/gtc/matrix_transform.hpp>
 
-Cube::Cube() {}
+namespace {
 
-Cube::Cube(GLuint shaderProgram)
+const GLfloat PUZZLE_SIZE        = 6.0f;   // Side of the whole puzzle, whatever its size
+const GLfloat BEVEL              = 0.083f; // Bevel width as a fraction of a cubie's side
+const GLfloat MATERIAL_SHININESS = 50.0f;
+const int     TURN_FRAMES        = 20;     // Frames a turn is animated over with none queued
+const int     MIN_TURN_FRAMES    = 3;      // Frames a turn is animated over however many are
+const int     SPEEDUP_QUEUED     = 4;      // Moves queued at which turns are twice as fast
+
+// Axis of each face's layers and whether its layer 0 is at the positive end, in CubeState face
+// order U, R, F, D, L, B
+const int  FACE_AXIS[CubeState::N_FACES]     = {1, 0, 2, 1, 0, 2};
+const bool FACE_POSITIVE[CubeState::N_FACES] = {true, true, true, false, false, false};
+
+/**
+ * Colour of the sticker a cubie has on a face, with the faces laid out as for NxNCubeState, or
+ * CubieMesh::PLASTIC if the face is inside the puzzle.
+ *
+ * @param layer The cubie's layer along the x, y and z axes
+ */
+GLuint stickerColour(const NxNCubeState& stickers, const int layer[3], int face)
 {
-    Importer importer("resources/models/cub3.q3d");
-    std::vector<Importer::Mesh> objects = importer.getObjects();
-    for(Importer::Mesh& mesh : objects)
+    int last = stickers.getSize() - 1;
+    int x = layer[0];
+    int y = layer[1];
+    int z = layer[2];
+    switch(face)
     {
-            std::vector<glm::vec3> vs = mesh.vs;
-            std::vector<glm::vec3> ns = mesh.ns;
-            std::vector<glm::vec2> uv = mesh.uvs;
-            std::string texture       = mesh.texturePath;
-            GLuint vertexCount        = mesh.vsSize;
-
-            Model model(vs, ns, uv, texture, vertexCount, shaderProgram, 50.0f, true);
-            cubes.push_back(model);
+        case CubeState::U:
+            return y == last ? stickers.getSticker(face, z, x) : CubieMesh::PLASTIC;
+        case CubeState::R:
+            return x == last ? stickers.getSticker(face, last - y, last - z) : CubieMesh::PLASTIC;
+        case CubeState::F:
+            return z == last ? stickers.getSticker(face, last - y, x) : CubieMesh::PLASTIC;
+        case CubeState::D:
+            return y == 0 ? stickers.getSticker(face, last - z, x) : CubieMesh::PLASTIC;
+        case CubeState::L:
+            return x == 0 ? stickers.getSticker(face, last - y, z) : CubieMesh::PLASTIC;
+        default:
+            return z == 0 ? stickers.getSticker(face, last - y, last - x) : CubieMesh::PLASTIC;
     }
 }
 
+} // namespace
+
+Cube::Cube() :
+shaderProgram{0},
+shininessLocation{-1},
+size{3},
+stickers{3},
+current{0, 0, 0, 0, 0},
+instancesChanged{false},
+transformUpdates{0},
+placements{0}
+{}
+
+Cube::Cube(GLuint shaderProgram, int size) :
+shaderProgram{shaderProgram},
+shininessLocation{glGetUniformLocation(shaderProgram, "materialShininess")},
+size{size},
+mesh{PUZZLE_SIZE / size, BEVEL},
+stickers{size},
+current{0, 0, 0, 0, 0},
+instancesChanged{true},
+transformUpdates{0},
+placements{0}
+{
+    GLfloat pitch = PUZZLE_SIZE / size;
+    GLfloat middle = (size - 1) / 2.0f;
+    for(int x = 0; x < size; ++x)
+    {
+        for(int y = 0; y < size; ++y)
+        {
+            for(int z = 0; z < size; ++z)
+            {
+                bool inside = x > 0 && x < size - 1 && y > 0 && y < size - 1 && z > 0 && z < size - 1;
+                if(!inside)
+                {
+                    glm::vec3 centre = glm::vec3(x - middle, y - middle, z - middle) * pitch;
+                    Slot slot = {{x, y, z}, glm::translate(glm::mat4(1.0f), centre)};
+                    slots.push_back(slot);
+                }
+            }
+        }
+    }
+    instances.resize(slots.size());
+    colourInstances();
+    placeInstances();
+}
+
 Cube::~Cube() {}
 
-void Cube::renderShadowMap(GLuint shadowProgram)
+void Cube::renderShadowMap()
+{
+    mesh.renderShadowMap();
+}
+
+void Cube::render()
+{
+    glUniform1f(shininessLocation, MATERIAL_SHININESS);
+
+    mesh.render();
+}
+
+void Cube::operations()
 {
-    for(Model& cube : cubes)
+    bool rotating = isRotating();
+    if(rotating && ++current.frame > current.frames)
     {
-        cube.renderShadowMap(shadowProgram);
+        stickers.turn(current.face, current.layer, current.turns);
+        current.frame = 0;
+        colourInstances();
     }
+    // The next move starts on the frame the last one ends, so a queue plays without pauses
+    if(!isRotating() && !queue.empty())
+    {
+        int move = queue.front();
+        queue.erase(queue.begin());
+        turn(move);
+    }
+    if(rotating || isRotating())
+    {
+        placeInstances();
+    }
+    if(instancesChanged)
+    {
+        mesh.setInstances(instances);
+        instancesChanged = false;
+    }
+}
+
+void Cube::rotateFront(bool clockwise)
+{
+    play({CubeState::moveIndex(CubeState::F, clockwise ? 1 : 3)});
+}
+
+void Cube::rotateBack(bool clockwise)
+{
+    play({CubeState::moveIndex(CubeState::B, clockwise ? 1 : 3)});
+}
+
+void Cube::rotateLeft(bool clockwise)
+{
+    play({CubeState::moveIndex(CubeState::L, clockwise ? 1 : 3)});
 }
 
-void Cube::render(glm::mat4 viewProjectionMatrix, glm::mat4 depthBiasMVP)
+void Cube::rotateRight(bool clockwise)
 {
-    for(Model& cube : cubes)
+    play({CubeState::moveIndex(CubeState::R, clockwise ? 1 : 3)});
+}
+
+void Cube::rotateTop(bool clockwise)
+{
+    play({CubeState::moveIndex(CubeState::U, clockwise ? 1 : 3)});
+}
+
+void Cube::rotateBottom(bool clockwise)
+{
+    play({CubeState::moveIndex(CubeState::D, clockwise ? 1 : 3)});
+}
+
+bool Cube::play(const std::vector<int>& moves)
+{
+    std::vector<int> queued = queue;
+    queued.insert(queued.end(), moves.begin(), moves.end());
+    CubeState::canonicalize(queued);
+    if(queued.size() > MAX_QUEUED)
     {
-        cube.render(viewProjectionMatrix, depthBiasMVP);
+        return false;
     }
+    queue.swap(queued);
+    return true;
 }
 
-void Cube::operations()
+const CubeState& Cube::getState() const
+{
+    return state;
+}
+
+CubeState Cube::getFinalState() const
 {
-    for(Model& cube : cubes)
+    CubeState final = state;
+    final.apply(queue);
+    return final;
+}
+
+bool Cube::setState(const CubeState& state)
+{
+    if(size != 3)
     {
-        cube.operations();
+        return false;
     }
+    this->state = state;
+    queue.clear();
+    current.frame = 0;
+
+    // The facelet string lists the stickers in NxNCubeState's layout, named after their faces
+    const std::string faceNames = "URFDLB";
+    std::string facelets = Facelets::fromState(state);
+    for(int i = 0; i < Facelets::N_FACELETS; ++i)
+    {
+        stickers.setSticker(i / 9, i % 9 / 3, i % 3, faceNames.find(facelets[i]));
+    }
+    colourInstances();
+    placeInstances();
+    return true;
 }
 
-void Cube::rotateFront(GLfloat angle, bool clockwise)
+int Cube::getSize() const
 {
-    rotate(angle, glm::vec3(0.0f, 0.0f, 1.0f), frontFace, clockwise);
+    return size;
 }
 
-void Cube::rotateBack(GLfloat angle, bool clockwise)
+unsigned long Cube::getTransformUpdates() const
 {
-    rotate(angle, glm::vec3(0.0f, 0.0f, 1.0f), backFace, clockwise);
+    return transformUpdates;
 }
 
-void Cube::rotateLeft(GLfloat angle, bool clockwise)
+unsigned long Cube::getPlacementCount() const
 {
-    rotate(angle, glm::vec3(1.0f, 0.0f,0.0f), leftFace, clockwise);
+    return placements;
 }
 
-void Cube::rotateRight(GLfloat angle, bool clockwise)
+void Cube::turn(int move)
 {
-    rotate(angle, glm::vec3(1.0f, 0.0f, 0.0f), rightFace, clockwise);
+    state.apply(move);
+    turnLayer(CubeState::moveFace(move), 0, CubeState::movePower(move));
 }
 
-void Cube::rotateTop(GLfloat angle, bool clockwise)
+void Cube::turnLayer(int face, int layer, int turns)
 {
-    rotate(angle, glm::vec3(0.0f, 1.0f, 0.0f), topFace, clockwise);
+    int frames = TURN_FRAMES * SPEEDUP_QUEUED / (SPEEDUP_QUEUED + (int)queue.size());
+    current = {face, layer, turns, 1, std::max(frames, MIN_TURN_FRAMES)};
 }
 
-void Cube::rotateBottom(GLfloat angle, bool clockwise)
+bool Cube::isRotating()
 {
-    rotate(angle, glm::vec3(0.0f, 1.0f, 0.0f), bottomFace, clockwise);
+    return current.frame > 0;
 }
 
-void Cube::rotate(GLfloat angle, glm::vec3 axis, std::vector<int> face, bool clockwise)
+void Cube::colourInstances()
 {
-    bool rotating = false;
-    for(Model& cube : cubes)
+    for(unsigned int i = 0; i < slots.size(); ++i)
     {
-        if(cube.isRotating())
+        GLuint colours = 0;
+        for(int f = 0; f < CubeState::N_FACES; ++f)
         {
-            rotating = true;
+            colours |= stickerColour(stickers, slots[i].layer, f) << (f * CubieMesh::COLOUR_BITS);
         }
+        instances[i].colours = colours;
     }
+    instancesChanged = true;
+}
 
-    if(!rotating)
-    {
-        for(unsigned int i = 0; i < face.size(); ++i)
-        {
-            cubes[face[i]].localRotate(angle, axis, 0.05f);
-        }
+void Cube::placeInstances()
+{
+    // Angle of a clockwise quarter turn of each face, in CubeState face order U, R, F, D, L, B
+    static const GLfloat clockwise[CubeState::N_FACES] = {-90.0f, -90.0f, -90.0f, 90.0f, 90.0f, 90.0f};
 
-        if(clockwise)
-        {
-            Model temp = cubes[face[0]];
-            cubes[face[0]] = cubes[face[3]];
-            cubes[face[3]] = cubes[face[2]];
-            cubes[face[2]] = cubes[face[1]];
-            cubes[face[1]] = temp;
-            temp = cubes[face[4]];
-            cubes[face[4]] = cubes[face[7]];
-            cubes[face[7]] = cubes[face[6]];
-            cubes[face[6]] = cubes[face[5]];
-            cubes[face[5]] = temp;
-        }
-        else
+    for(unsigned int i = 0; i < slots.size(); ++i)
+    {
+        instances[i].transform = slots[i].transform;
+    }
+    if(isRotating())
+    {
+        GLfloat angle = current.turns == 3 ? -clockwise[current.face] : clockwise[current.face] * current.turns;
+        GLfloat progress = (GLfloat)current.frame / current.frames;
+        glm::vec3 axis(0.0f);
+        axis[FACE_AXIS[current.face]] = 1.0f;
+        glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(angle * progress), axis);
+        ++transformUpdates;
+        for(unsigned int i = 0; i < slots.size(); ++i)
         {
-            Model temp = cubes[face[0]];
-            cubes[face[0]] = cubes[face[1]];
-            cubes[face[1]] = cubes[face[2]];
-            cubes[face[2]] = cubes[face[3]];
-            cubes[face[3]] = temp;
-            temp = cubes[face[4]];
-            cubes[face[4]] = cubes[face[5]];
-            cubes[face[5]] = cubes[face[6]];
-            cubes[face[6]] = cubes[face[7]];
-            cubes[face[7]] = temp;
+            if(isInTurn(slots[i]))
+            {
+                instances[i].transform = rotation * slots[i].transform;
+                ++transformUpdates;
+            }
         }
     }
-}
\ No newline at end of file
+    instancesChanged = true;
+    ++placements;
+}
+
+bool Cube::isInTurn(const Slot& slot) const
+{
+    int position = slot.layer[FACE_AXIS[current.face]];
+    return FACE_POSITIVE[current.face] ? position == size - 1 - current.layer : position == current.layer;
+}
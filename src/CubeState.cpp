@@ -0,0 +1,506 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cctype>
+#include "../include/CubeState.hpp"
+
+namespace {
+
+const int FIELD_BITS = 5;
+const uint64_t FIELD_MASK = 31;
+
+// Slots of the 26-cubie layout (the object order in cub3.q3d) holding each corner and edge
+const int CORNER_SLOTS[CubeState::N_CORNERS] = {7, 6, 4, 5, 3, 2, 0, 1};
+const int EDGE_SLOTS[CubeState::N_EDGES]     = {19, 12, 18, 17, 16, 9, 14, 8, 11, 10, 13, 15};
+
+// Quarter turn of each face in "replaced by" form: position i receives the cubie from position
+// cp[i] and has its orientation increased by co[i]
+const int FACE_CP[CubeState::N_FACES][CubeState::N_CORNERS] = {
+    {3, 0, 1, 2, 4, 5, 6, 7}, // U
+    {4, 1, 2, 0, 7, 5, 6, 3}, // R
+    {1, 5, 2, 3, 0, 4, 6, 7}, // F
+    {0, 1, 2, 3, 5, 6, 7, 4}, // D
+    {0, 2, 6, 3, 4, 1, 5, 7}, // L
+    {0, 1, 3, 7, 4, 5, 2, 6}  // B
+};
+const int FACE_CO[CubeState::N_FACES][CubeState::N_CORNERS] = {
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {2, 0, 0, 1, 1, 0, 0, 2},
+    {1, 2, 0, 0, 2, 1, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 0, 0, 2, 1, 0},
+    {0, 0, 1, 2, 0, 0, 2, 1}
+};
+const int FACE_EP[CubeState::N_FACES][CubeState::N_EDGES] = {
+    {3, 0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11},
+    {8, 1, 2, 3, 11, 5, 6, 7, 4, 9, 10, 0},
+    {0, 9, 2, 3, 4, 8, 6, 7, 1, 5, 10, 11},
+    {0, 1, 2, 3, 5, 6, 7, 4, 8, 9, 10, 11},
+    {0, 1, 10, 3, 4, 5, 9, 7, 8, 2, 6, 11},
+    {0, 1, 2, 11, 4, 5, 6, 10, 8, 9, 3, 7}
+};
+const int FACE_EO[CubeState::N_FACES][CubeState::N_EDGES] = {
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1}
+};
+
+/**
+ * Per-move table. A face turn moves exactly four corners and four edges, so a move keeps the
+ * untouched fields with a mask and rewrites the other four of each word.
+ */
+struct Move
+{
+    uint64_t cornerKeep;
+    uint64_t edgeKeep;
+    uint8_t cornerDst[4];   // Shift of the destination field
+    uint8_t cornerSrc[4];   // Shift of the source field
+    uint8_t cornerTwist[4];
+    uint8_t edgeDst[4];
+    uint8_t edgeSrc[4];
+    uint8_t edgeFlip[4];    // Already shifted into the flip bit
+};
+
+struct MoveTables
+{
+    Move moves[CubeState::N_MOVES];
+    uint8_t addTwist[3][32]; // Corner field with twist added, mod 3
+
+    MoveTables()
+    {
+        for(int t = 0; t < 3; ++t)
+        {
+            for(int f = 0; f < 32; ++f)
+            {
+                int twist = ((f >> 3) + t) % 3;
+                addTwist[t][f] = (uint8_t)((f & 7) | (twist << 3));
+            }
+        }
+
+        for(int face = 0; face < CubeState::N_FACES; ++face)
+        {
+            int cp[CubeState::N_CORNERS];
+            int co[CubeState::N_CORNERS];
+            int ep[CubeState::N_EDGES];
+            int eo[CubeState::N_EDGES];
+            for(int i = 0; i < CubeState::N_CORNERS; ++i)
+            {
+                cp[i] = i;
+                co[i] = 0;
+            }
+            for(int i = 0; i < CubeState::N_EDGES; ++i)
+            {
+                ep[i] = i;
+                eo[i] = 0;
+            }
+
+            for(int power = 0; power < 3; ++power)
+            {
+                // Compose one more quarter turn onto the previous power
+                int ncp[CubeState::N_CORNERS];
+                int nco[CubeState::N_CORNERS];
+                int nep[CubeState::N_EDGES];
+                int neo[CubeState::N_EDGES];
+                for(int i = 0; i < CubeState::N_CORNERS; ++i)
+                {
+                    ncp[i] = cp[FACE_CP[face][i]];
+                    nco[i] = (co[FACE_CP[face][i]] + FACE_CO[face][i]) % 3;
+                }
+                for(int i = 0; i < CubeState::N_EDGES; ++i)
+                {
+                    nep[i] = ep[FACE_EP[face][i]];
+                    neo[i] = (eo[FACE_EP[face][i]] + FACE_EO[face][i]) % 2;
+                }
+                for(int i = 0; i < CubeState::N_CORNERS; ++i)
+                {
+                    cp[i] = ncp[i];
+                    co[i] = nco[i];
+                }
+                for(int i = 0; i < CubeState::N_EDGES; ++i)
+                {
+                    ep[i] = nep[i];
+                    eo[i] = neo[i];
+                }
+
+                Move& m = moves[face * 3 + power];
+                m.cornerKeep = ~0ULL;
+                m.edgeKeep = ~0ULL;
+                int k = 0;
+                for(int i = 0; i < CubeState::N_CORNERS; ++i)
+                {
+                    if(cp[i] != i || co[i] != 0)
+                    {
+                        m.cornerKeep &= ~(FIELD_MASK << (FIELD_BITS * i));
+                        m.cornerDst[k] = (uint8_t)(FIELD_BITS * i);
+                        m.cornerSrc[k] = (uint8_t)(FIELD_BITS * cp[i]);
+                        m.cornerTwist[k] = (uint8_t)co[i];
+                        ++k;
+                    }
+                }
+                k = 0;
+                for(int i = 0; i < CubeState::N_EDGES; ++i)
+                {
+                    if(ep[i] != i || eo[i] != 0)
+                    {
+                        m.edgeKeep &= ~(FIELD_MASK << (FIELD_BITS * i));
+                        m.edgeDst[k] = (uint8_t)(FIELD_BITS * i);
+                        m.edgeSrc[k] = (uint8_t)(FIELD_BITS * ep[i]);
+                        m.edgeFlip[k] = (uint8_t)(eo[i] << 4);
+                        ++k;
+                    }
+                }
+            }
+        }
+    }
+};
+
+const MoveTables& moveTables()
+{
+    static const MoveTables tables;
+    return tables;
+}
+
+} // namespace
+
+CubeState::CubeState() :
+corners{0},
+edges{0}
+{
+    for(int i = 0; i < N_CORNERS; ++i)
+    {
+        corners |= (uint64_t)i << (FIELD_BITS * i);
+    }
+    for(int i = 0; i < N_EDGES; ++i)
+    {
+        edges |= (uint64_t)i << (FIELD_BITS * i);
+    }
+}
+
+void CubeState::apply(int move)
+{
+    const MoveTables& t = moveTables();
+    const Move& m = t.moves[move];
+
+    uint64_t c = corners & m.cornerKeep;
+    uint64_t e = edges & m.edgeKeep;
+    for(int k = 0; k < 4; ++k)
+    {
+        uint64_t field = (corners >> m.cornerSrc[k]) & FIELD_MASK;
+        c |= (uint64_t)t.addTwist[m.cornerTwist[k]][field] << m.cornerDst[k];
+
+        field = ((edges >> m.edgeSrc[k]) & FIELD_MASK) ^ m.edgeFlip[k];
+        e |= field << m.edgeDst[k];
+    }
+    corners = c;
+    edges = e;
+}
+
+void CubeState::apply(const std::vector<int>& moves)
+{
+    for(int move : moves)
+    {
+        apply(move);
+    }
+}
+
+int CubeState::cornerPermutation(int position) const
+{
+    return (corners >> (FIELD_BITS * position)) & 7;
+}
+
+int CubeState::cornerOrientation(int position) const
+{
+    return (corners >> (FIELD_BITS * position + 3)) & 3;
+}
+
+int CubeState::edgePermutation(int position) const
+{
+    return (edges >> (FIELD_BITS * position)) & 15;
+}
+
+int CubeState::edgeOrientation(int position) const
+{
+    return (edges >> (FIELD_BITS * position + 4)) & 1;
+}
+
+void CubeState::setCorner(int position, int cubie, int orientation)
+{
+    corners &= ~(FIELD_MASK << (FIELD_BITS * position));
+    corners |= (uint64_t)(cubie | (orientation << 3)) << (FIELD_BITS * position);
+}
+
+void CubeState::setEdge(int position, int cubie, int orientation)
+{
+    edges &= ~(FIELD_MASK << (FIELD_BITS * position));
+    edges |= (uint64_t)(cubie | (orientation << 4)) << (FIELD_BITS * position);
+}
+
+bool CubeState::isSolved() const
+{
+    return *this == CubeState();
+}
+
+bool CubeState::isSolvable() const
+{
+    // Straight-line so a stream of positions can be screened without mispredictions. Going
+    // from the last position back, the cubies seen so far that are lower than the current one
+    // are its inversions; only the parity of their total matters, and that is the parity of
+    // the XOR of the masks. Corners and edges share the mask, so it comes out even exactly
+    // when the two permutation parities match
+    uint32_t seen = 0;
+    uint32_t inversions = 0;
+    int twist = 0;
+    int badTwist = 0;
+    for(int i = N_CORNERS - 1; i >= 0; --i)
+    {
+        uint32_t cubie = 1u << cornerPermutation(i);
+        inversions ^= seen & (cubie - 1);
+        seen |= cubie;
+        twist += cornerOrientation(i);
+        badTwist |= cornerOrientation(i) == 3;
+    }
+    bool corners = seen == (1u << N_CORNERS) - 1;
+
+    seen = 0;
+    int flip = 0;
+    for(int i = N_EDGES - 1; i >= 0; --i)
+    {
+        uint32_t cubie = 1u << edgePermutation(i);
+        inversions ^= seen & (cubie - 1);
+        seen |= cubie;
+        flip += edgeOrientation(i);
+    }
+    bool edges = seen == (1u << N_EDGES) - 1;
+    return corners & edges & !badTwist & (twist % 3 == 0) & (flip % 2 == 0) & !__builtin_parity(inversions);
+}
+
+CubeState CubeState::inverse() const
+{
+    CubeState result;
+    for(int i = 0; i < N_CORNERS; ++i)
+    {
+        result.setCorner(cornerPermutation(i), i, (3 - cornerOrientation(i)) % 3);
+    }
+    for(int i = 0; i < N_EDGES; ++i)
+    {
+        result.setEdge(edgePermutation(i), i, edgeOrientation(i));
+    }
+    return result;
+}
+
+uint64_t CubeState::getCornerWord() const
+{
+    return corners;
+}
+
+uint64_t CubeState::getEdgeWord() const
+{
+    return edges;
+}
+
+void CubeState::setWords(uint64_t cornerWord, uint64_t edgeWord)
+{
+    corners = cornerWord;
+    edges = edgeWord;
+}
+
+bool CubeState::operator==(const CubeState& other) const
+{
+    return corners == other.corners && edges == other.edges;
+}
+
+bool CubeState::operator!=(const CubeState& other) const
+{
+    return !(*this == other);
+}
+
+int CubeState::cubieAt(int slot) const
+{
+    for(int i = 0; i < N_CORNERS; ++i)
+    {
+        if(CORNER_SLOTS[i] == slot)
+        {
+            return CORNER_SLOTS[cornerPermutation(i)];
+        }
+    }
+    for(int i = 0; i < N_EDGES; ++i)
+    {
+        if(EDGE_SLOTS[i] == slot)
+        {
+            return EDGE_SLOTS[edgePermutation(i)];
+        }
+    }
+    return slot; // Centres
+}
+
+int CubeState::cornerSlot(int corner)
+{
+    return CORNER_SLOTS[corner];
+}
+
+int CubeState::edgeSlot(int edge)
+{
+    return EDGE_SLOTS[edge];
+}
+
+int CubeState::moveIndex(int face, int quarterTurns)
+{
+    return face * 3 + ((quarterTurns % 4 + 4) % 4) - 1;
+}
+
+int CubeState::moveFace(int move)
+{
+    return move / 3;
+}
+
+int CubeState::movePower(int move)
+{
+    return move % 3 + 1;
+}
+
+int CubeState::inverseMove(int move)
+{
+    return move - move % 3 + (2 - move % 3);
+}
+
+uint32_t CubeState::followingMoves(int previous)
+{
+    static const struct Following
+    {
+        uint32_t masks[N_MOVES];
+
+        Following()
+        {
+            for(int previous = 0; previous < N_MOVES; ++previous)
+            {
+                masks[previous] = 0;
+                int previousFace = moveFace(previous);
+                for(int move = 0; move < N_MOVES; ++move)
+                {
+                    int face = moveFace(move);
+                    if(face != previousFace && previousFace != face + 3)
+                    {
+                        masks[previous] |= 1u << move;
+                    }
+                }
+            }
+        }
+    } following;
+    return previous < 0 ? (1u << N_MOVES) - 1 : following.masks[previous];
+}
+
+void CubeState::canonicalize(std::vector<int>& moves)
+{
+    std::vector<int> result;
+    for(int move : moves)
+    {
+        int face = moveFace(move);
+        int opposite = (face + 3) % N_FACES;
+        size_t n = result.size();
+
+        // The turn merges with the last one of its face unless a turn of another axis is between
+        int merge = -1;
+        if(n > 0 && moveFace(result[n - 1]) == face)
+        {
+            merge = (int)n - 1;
+        }
+        else if(n > 1 && moveFace(result[n - 1]) == opposite && moveFace(result[n - 2]) == face)
+        {
+            merge = (int)n - 2;
+        }
+
+        if(merge >= 0)
+        {
+            int quarterTurns = (movePower(result[merge]) + movePower(move)) % 4;
+            if(quarterTurns == 0)
+            {
+                result.erase(result.begin() + merge);
+            }
+            else
+            {
+                result[merge] = moveIndex(face, quarterTurns);
+            }
+        }
+        else if(n > 0 && moveFace(result[n - 1]) == face + 3)
+        {
+            result.insert(result.end() - 1, move);
+        }
+        else
+        {
+            result.push_back(move);
+        }
+    }
+    moves.swap(result);
+}
+
+std::string CubeState::moveName(int move)
+{
+    static const char faces[] = "URFDLB";
+    static const char* powers[] = {"", "2", "'"};
+    return std::string(1, faces[moveFace(move)]) + powers[move % 3];
+}
+
+bool CubeState::parseMoves(const std::string& text, std::vector<int>& moves)
+{
+    static const std::string faces = "URFDLB";
+    moves.clear();
+    for(size_t i = 0; i < text.size(); ++i)
+    {
+        if(isspace((unsigned char)text[i]))
+        {
+            continue;
+        }
+        size_t face = faces.find(text[i]);
+        if(face == std::string::npos)
+        {
+            return false;
+        }
+        int quarterTurns = 1;
+        if(i + 1 < text.size() && text[i + 1] == '2')
+        {
+            quarterTurns = 2;
+            ++i;
+        }
+        // Accept R2' as well as R2
+        if(i + 1 < text.size() && text[i + 1] == '\'')
+        {
+            quarterTurns = -quarterTurns;
+            ++i;
+        }
+        moves.push_back(moveIndex((int)face, quarterTurns));
+    }
+    return true;
+}
+
+std::string CubeState::formatMoves(const std::vector<int>& moves)
+{
+    std::string text;
+    for(size_t i = 0; i < moves.size(); ++i)
+    {
+        if(i > 0)
+        {
+            text += ' ';
+        }
+        text += moveName(moves[i]);
+    }
+    return text;
+}
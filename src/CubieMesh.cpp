@@ -0,0 +1,236 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstddef>
+#include <utility>
+#include "../include/CubieMesh.hpp"
+#include "../include/MeshOptimizer.hpp"
+
+namespace {
+
+const GLuint FACE_LOCATION      = 2;
+const GLuint TRANSFORM_LOCATION = 3; // First of four, one per column
+const GLuint COLOURS_LOCATION   = 7;
+
+// Axis and direction of the outward normal of each face, in CubeState face order U, R, F, D, L, B
+const int FACE_AXIS[6] = {1, 0, 2, 1, 0, 2};
+const int FACE_SIGN[6] = {1, 1, 1, -1, -1, -1};
+
+/**
+ * Vector along one axis.
+ */
+glm::vec3 along(int axis, GLfloat value)
+{
+    glm::vec3 v(0.0f);
+    v[axis] = value;
+    return v;
+}
+
+/**
+ * A vertex as laid out in the vertex buffer.
+ */
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    GLuint face;
+};
+
+/**
+ * Flat-shaded triangles of the cubie mesh.
+ */
+struct Geometry
+{
+    std::vector<Vertex> vertices;
+
+    /**
+     * Add a triangle, wound anticlockwise as seen from outside so back-face culling keeps it.
+     */
+    void triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 normal, GLuint face)
+    {
+        if(glm::dot(glm::cross(b - a, c - a), normal) < 0.0f)
+        {
+            std::swap(b, c);
+        }
+        for(const glm::vec3& p : {a, b, c})
+        {
+            Vertex vertex = {p, normal, face};
+            vertices.push_back(vertex);
+        }
+    }
+
+    void quad(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 normal, GLuint face)
+    {
+        triangle(a, b, c, normal, face);
+        triangle(a, c, d, normal, face);
+    }
+};
+
+/**
+ * Build a cubie centred on the origin: a square for each face, inset from the corners of the
+ * cube by the bevel, a strip joining each pair of neighbouring faces and a triangle at each
+ * corner.
+ */
+Geometry buildCubie(GLfloat size, GLfloat bevel)
+{
+    GLfloat outer = size / 2.0f;
+    GLfloat inner = outer - bevel * size;
+    Geometry g;
+
+    for(int f = 0; f < 6; ++f)
+    {
+        int a = FACE_AXIS[f];
+        int u = (a + 1) % 3;
+        int v = (a + 2) % 3;
+        glm::vec3 centre = along(a, FACE_SIGN[f] * outer);
+        g.quad(centre + along(u, -inner) + along(v, -inner), centre + along(u, inner) + along(v, -inner),
+               centre + along(u, inner) + along(v, inner), centre + along(u, -inner) + along(v, inner),
+               along(a, (GLfloat)FACE_SIGN[f]), f);
+    }
+
+    for(int a1 = 0; a1 < 3; ++a1)
+    {
+        for(int a2 = a1 + 1; a2 < 3; ++a2)
+        {
+            int a3 = 3 - a1 - a2;
+            for(GLfloat s1 : {-1.0f, 1.0f})
+            {
+                for(GLfloat s2 : {-1.0f, 1.0f})
+                {
+                    glm::vec3 first = along(a1, s1 * outer) + along(a2, s2 * inner);
+                    glm::vec3 second = along(a1, s1 * inner) + along(a2, s2 * outer);
+                    g.quad(first + along(a3, -inner), first + along(a3, inner),
+                           second + along(a3, inner), second + along(a3, -inner),
+                           glm::normalize(along(a1, s1) + along(a2, s2)), CubieMesh::PLASTIC);
+                }
+            }
+        }
+    }
+
+    for(int corner = 0; corner < 8; ++corner)
+    {
+        glm::vec3 sign((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+        glm::vec3 base = sign * inner;
+        g.triangle(base + along(0, sign.x * (outer - inner)), base + along(1, sign.y * (outer - inner)),
+                   base + along(2, sign.z * (outer - inner)), glm::normalize(sign), CubieMesh::PLASTIC);
+    }
+    return g;
+}
+
+template <typename T>
+GLuint createVBO(GLenum target, const std::vector<T>& data)
+{
+    GLuint VBO;
+    glGenBuffers(1, &VBO);
+    glBindBuffer(target, VBO);
+    glBufferData(target, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW);
+    return VBO;
+}
+
+} // namespace
+
+CubieMesh::CubieMesh() {}
+
+CubieMesh::CubieMesh(GLfloat size, GLfloat bevel) :
+instanceCount{0},
+instanceCapacity{0}
+{
+    Geometry g = buildCubie(size, bevel);
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices = MeshOptimizer::weld(g.vertices, vertices);
+    MeshOptimizer::optimizeVertexCache(indices, vertices.size());
+    MeshOptimizer::optimizeVertexFetch(indices, vertices);
+    VBOvertex = createVBO(GL_ARRAY_BUFFER, vertices);
+    EBO = createVBO(GL_ELEMENT_ARRAY_BUFFER, indices);
+    indexCount = indices.size();
+    glGenBuffers(1, &VBOinstance);
+    VAO = createVertexArray(false);
+    shadowVAO = createVertexArray(true);
+}
+
+CubieMesh::~CubieMesh() {}
+
+void CubieMesh::setInstances(const std::vector<Instance>& instances)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, VBOinstance);
+    GLsizeiptr bytes = instances.size() * sizeof(Instance);
+    if(instances.size() > instanceCapacity)
+    {
+        glBufferData(GL_ARRAY_BUFFER, bytes, instances.data(), GL_DYNAMIC_DRAW);
+        instanceCapacity = instances.size();
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+    }
+    instanceCount = instances.size();
+}
+
+void CubieMesh::renderShadowMap()
+{
+    glBindVertexArray(shadowVAO);
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instanceCount);
+}
+
+void CubieMesh::render()
+{
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instanceCount);
+}
+
+GLuint CubieMesh::createVertexArray(bool shadow)
+{
+    GLuint vertexArray;
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBOvertex);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(0);
+    if(!shadow)
+    {
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, normal));
+        glEnableVertexAttribArray(1);
+        glVertexAttribIPointer(FACE_LOCATION, 1, GL_UNSIGNED_INT, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, face));
+        glEnableVertexAttribArray(FACE_LOCATION);
+    }
+
+    // The attributes refer to the buffer, so they survive it being reallocated by setInstances
+    glBindBuffer(GL_ARRAY_BUFFER, VBOinstance);
+    for(GLuint column = 0; column < 4; ++column)
+    {
+        GLuint location = TRANSFORM_LOCATION + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              (const GLvoid*)(offsetof(Instance, transform) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+        glEnableVertexAttribArray(location);
+    }
+    if(!shadow)
+    {
+        glVertexAttribIPointer(COLOURS_LOCATION, 1, GL_UNSIGNED_INT, sizeof(Instance),
+                               (const GLvoid*)offsetof(Instance, colours));
+        glVertexAttribDivisor(COLOURS_LOCATION, 1);
+        glEnableVertexAttribArray(COLOURS_LOCATION);
+    }
+
+    glBindVertexArray(0);
+    return vertexArray;
+}
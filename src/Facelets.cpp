@@ -0,0 +1,195 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include "../include/Facelets.hpp"
+
+namespace {
+
+// Facelet indices: U1-U9 are 0-8, R1-R9 9-17, F1-F9 18-26, D1-D9 27-35, L1-L9 36-44, B1-B9 45-53
+const int CENTRES[CubeState::N_FACES] = {4, 13, 22, 31, 40, 49};
+
+// The facelets of each corner position, starting with its U or D facelet and going clockwise
+const int CORNER_FACELETS[CubeState::N_CORNERS][3] = {
+    {8, 9, 20},   // URF
+    {6, 18, 38},  // UFL
+    {0, 36, 47},  // ULB
+    {2, 45, 11},  // UBR
+    {29, 26, 15}, // DFR
+    {27, 44, 24}, // DLF
+    {33, 53, 42}, // DBL
+    {35, 17, 51}  // DRB
+};
+
+// The facelets of each edge position, the U or D facelet first, else the F or B facelet
+const int EDGE_FACELETS[CubeState::N_EDGES][2] = {
+    {5, 10},  // UR
+    {7, 19},  // UF
+    {3, 37},  // UL
+    {1, 46},  // UB
+    {32, 16}, // DR
+    {28, 25}, // DF
+    {30, 43}, // DL
+    {34, 52}, // DB
+    {23, 12}, // FR
+    {21, 41}, // FL
+    {50, 39}, // BL
+    {48, 14}  // BR
+};
+
+const int CORNER_COLOURS[CubeState::N_CORNERS][3] = {
+    {CubeState::U, CubeState::R, CubeState::F}, {CubeState::U, CubeState::F, CubeState::L},
+    {CubeState::U, CubeState::L, CubeState::B}, {CubeState::U, CubeState::B, CubeState::R},
+    {CubeState::D, CubeState::F, CubeState::R}, {CubeState::D, CubeState::L, CubeState::F},
+    {CubeState::D, CubeState::B, CubeState::L}, {CubeState::D, CubeState::R, CubeState::B}
+};
+
+const int EDGE_COLOURS[CubeState::N_EDGES][2] = {
+    {CubeState::U, CubeState::R}, {CubeState::U, CubeState::F}, {CubeState::U, CubeState::L},
+    {CubeState::U, CubeState::B}, {CubeState::D, CubeState::R}, {CubeState::D, CubeState::F},
+    {CubeState::D, CubeState::L}, {CubeState::D, CubeState::B}, {CubeState::F, CubeState::R},
+    {CubeState::F, CubeState::L}, {CubeState::B, CubeState::L}, {CubeState::B, CubeState::R}
+};
+
+const char FACE_NAMES[] = "URFDLB";
+
+/**
+ * Cubie and orientation for every combination of faces a corner or edge position can show,
+ * packed as in CubeState (cubie | twist << 3, cubie | flip << 4), or INVALID if no cubie
+ * shows it. Corners are keyed by the faces of their facelets in CORNER_FACELETS order as
+ * 36 * first + 6 * second + third, edges as 6 * first + second.
+ */
+struct Lookup
+{
+    static const uint8_t INVALID = 0xff;
+
+    uint8_t corner[CubeState::N_FACES * CubeState::N_FACES * CubeState::N_FACES];
+    uint8_t edge[CubeState::N_FACES * CubeState::N_FACES];
+
+    Lookup()
+    {
+        std::fill(corner, corner + sizeof(corner), INVALID);
+        std::fill(edge, edge + sizeof(edge), INVALID);
+        for(int cubie = 0; cubie < CubeState::N_CORNERS; ++cubie)
+        {
+            for(int twist = 0; twist < 3; ++twist)
+            {
+                // A twist of t puts the cubie's U or D colour on facelet t
+                int faces[3];
+                for(int k = 0; k < 3; ++k)
+                {
+                    faces[(twist + k) % 3] = CORNER_COLOURS[cubie][k];
+                }
+                corner[36 * faces[0] + 6 * faces[1] + faces[2]] = cubie | twist << 3;
+            }
+        }
+        for(int cubie = 0; cubie < CubeState::N_EDGES; ++cubie)
+        {
+            edge[6 * EDGE_COLOURS[cubie][0] + EDGE_COLOURS[cubie][1]] = cubie;
+            edge[6 * EDGE_COLOURS[cubie][1] + EDGE_COLOURS[cubie][0]] = cubie | 1 << 4;
+        }
+    }
+};
+
+const uint8_t Lookup::INVALID;
+
+const Lookup lookup;
+
+} // namespace
+
+bool Facelets::toState(const std::string& facelets, CubeState& state)
+{
+    if(facelets.size() != N_FACELETS)
+    {
+        return false;
+    }
+
+    // Map each character to the face whose centre has it. Rather than branch on every facelet,
+    // the lookups are ORed together: only INVALID sets bit 7
+    uint8_t faceOf[256];
+    std::fill(faceOf, faceOf + 256, Lookup::INVALID);
+    const unsigned char* colours = (const unsigned char*)facelets.data();
+    for(int f = 0; f < CubeState::N_FACES; ++f)
+    {
+        faceOf[colours[CENTRES[f]]] = f;
+    }
+    bool repeated = false; // Two centres of one colour
+    for(int f = 0; f < CubeState::N_FACES; ++f)
+    {
+        repeated |= faceOf[colours[CENTRES[f]]] != f;
+    }
+    uint8_t faces[N_FACELETS];
+    unsigned int found = 0;
+    for(int i = 0; i < N_FACELETS; ++i)
+    {
+        faces[i] = faceOf[colours[i]];
+        found |= faces[i];
+    }
+    if(repeated || (found & 0x80))
+    {
+        return false;
+    }
+
+    // The lookups are already in CubeState's field format, so they go straight into its words
+    unsigned int pieces = 0;
+    uint64_t corners = 0;
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        const int* f = CORNER_FACELETS[i];
+        uint8_t corner = lookup.corner[36 * faces[f[0]] + 6 * faces[f[1]] + faces[f[2]]];
+        pieces |= corner;
+        corners |= (uint64_t)(corner & 31) << (5 * i);
+    }
+    uint64_t edges = 0;
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        const int* f = EDGE_FACELETS[i];
+        uint8_t edge = lookup.edge[6 * faces[f[0]] + faces[f[1]]];
+        pieces |= edge;
+        edges |= (uint64_t)(edge & 31) << (5 * i);
+    }
+    state.setWords(corners, edges);
+    return (pieces & 0x80) == 0;
+}
+
+std::string Facelets::fromState(const CubeState& state)
+{
+    std::string facelets(N_FACELETS, ' ');
+    for(int f = 0; f < CubeState::N_FACES; ++f)
+    {
+        facelets[CENTRES[f]] = FACE_NAMES[f];
+    }
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        int cubie = state.cornerPermutation(i);
+        int twist = state.cornerOrientation(i);
+        for(int k = 0; k < 3; ++k)
+        {
+            facelets[CORNER_FACELETS[i][(twist + k) % 3]] = FACE_NAMES[CORNER_COLOURS[cubie][k]];
+        }
+    }
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        int cubie = state.edgePermutation(i);
+        int flip = state.edgeOrientation(i);
+        facelets[EDGE_FACELETS[i][flip]] = FACE_NAMES[EDGE_COLOURS[cubie][0]];
+        facelets[EDGE_FACELETS[i][1 - flip]] = FACE_NAMES[EDGE_COLOURS[cubie][1]];
+    }
+    return facelets;
+}
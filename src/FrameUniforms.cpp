@@ -0,0 +1,68 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstddef>
+#include <cstring>
+#include "../include/FrameUniforms.hpp"
+
+// std140 offsets, which the Frame block in frame.glsl relies on
+static_assert(offsetof(FrameUniforms::Block, lightPosition) == 192, "Frame block layout");
+static_assert(offsetof(FrameUniforms::Block, lightDirection) == 224, "Frame block layout");
+static_assert(offsetof(FrameUniforms::Block, ambientLight) == 240, "Frame block layout");
+static_assert(offsetof(FrameUniforms::Block, cameraPosition) == 256, "Frame block layout");
+
+FrameUniforms::FrameUniforms() :
+UBO{0},
+current(),
+uploaded{false}
+{}
+
+FrameUniforms::~FrameUniforms() {}
+
+void FrameUniforms::init()
+{
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::bindProgram(GLuint shaderProgram)
+{
+    GLuint index = glGetUniformBlockIndex(shaderProgram, "Frame");
+    if(index != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(shaderProgram, index, BINDING);
+    }
+}
+
+void FrameUniforms::update(const Block& block)
+{
+    if(uploaded && memcmp(&block, &current, sizeof(Block)) == 0)
+    {
+        return;
+    }
+    current = block;
+    uploaded = true;
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &current);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
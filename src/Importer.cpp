@@ -23,10 +23,53 @@
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
 #include "../include/Importer.hpp"
+#include "../include/MeshOptimizer.hpp"
 
 #define DOCTYPE "q3d" // The 3D geometry file format
 
-Importer::Importer(std::string fileName)
+namespace {
+
+/**
+ * A vertex of a mesh, compared byte for byte when welding.
+ */
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+std::vector<Vertex> toVertices(const Importer::Mesh& mesh)
+{
+    std::vector<Vertex> vertices(mesh.vs.size());
+    for(unsigned int i = 0; i < vertices.size(); ++i)
+    {
+        // Adding 0 turns -0 into 0, which the exporter writes both of
+        vertices[i].position = mesh.vs[i] + 0.0f;
+        vertices[i].normal = mesh.ns[i] + 0.0f;
+        vertices[i].uv = mesh.uvs[i] + 0.0f;
+    }
+    return vertices;
+}
+
+void fromVertices(const std::vector<Vertex>& vertices, Importer::Mesh& mesh)
+{
+    mesh.vs.resize(vertices.size());
+    mesh.ns.resize(vertices.size());
+    mesh.uvs.resize(vertices.size());
+    for(unsigned int i = 0; i < vertices.size(); ++i)
+    {
+        mesh.vs[i] = vertices[i].position;
+        mesh.ns[i] = vertices[i].normal;
+        mesh.uvs[i] = vertices[i].uv;
+    }
+    mesh.vsSize = vertices.size();
+}
+
+} // namespace
+
+Importer::Importer(std::string fileName, bool indexed) :
+indexed{indexed}
 {
     loadXML(fileName);
     loadModel();
@@ -39,6 +82,21 @@ std::vector<Importer::Mesh> Importer::getObjects()
     return objects;
 }
 
+void Importer::weld(Mesh& mesh)
+{
+    std::vector<Vertex> vertices;
+    mesh.indices = MeshOptimizer::weld(toVertices(mesh), vertices);
+    fromVertices(vertices, mesh);
+}
+
+void Importer::optimize(Mesh& mesh)
+{
+    std::vector<Vertex> vertices = toVertices(mesh);
+    MeshOptimizer::optimizeVertexCache(mesh.indices, vertices.size());
+    MeshOptimizer::optimizeVertexFetch(mesh.indices, vertices);
+    fromVertices(vertices, mesh);
+}
+
 void Importer::loadXML(std::string fileName)
 {
     doc.LoadFile(fileName.c_str());
@@ -70,6 +128,7 @@ void Importer::loadModel()
 
 void Importer::loadObject(tinyxml2::XMLNode* object)
 {
+    std::string name = std::string(object->ToElement()->Attribute("id", nullptr));
     tinyxml2::XMLNode* mesh = object->FirstChild();
     while(mesh != nullptr)
     {
@@ -91,7 +150,18 @@ void Importer::loadObject(tinyxml2::XMLNode* object)
 
         std::string texturePath = std::string(texture->ToElement()->GetText());
 
-        Mesh m = {vertices, normals, uvs, texturePath, vsSize};
+        std::vector<unsigned int> indices(vsSize);
+        for(auto i = 0; i < vsSize; ++i)
+        {
+            indices[i] = i;
+        }
+
+        Mesh m = {name, vertices, normals, uvs, indices, texturePath, vsSize};
+        if(indexed)
+        {
+            weld(m);
+            optimize(m);
+        }
         objects.push_back(m);
 
         mesh = mesh->NextSibling();
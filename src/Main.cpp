@@ -17,11 +17,21 @@
   along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cstdlib>
+#include <iostream>
 #include "../include/Window.hpp"
 
 int main(int argc, char* argv[])
 {
-    Window window(1200, 1000);
+    // Optional number of layers, e.g. "cub3r 5" for a 5x5x5 cube
+    int cubeSize = argc > 1 ? atoi(argv[1]) : 3;
+    if(cubeSize < 2)
+    {
+        std::cout << "Usage: cub3r [size], where size is at least 2\n";
+        return 1;
+    }
+
+    Window window(1200, 1000, cubeSize);
     while(window.isRunning())
     {
         window.handleEvents();
@@ -0,0 +1,76 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+ * Mesh report, built as bin/cub3r-mesh. Links no SDL or GL.
+ *
+ * Usage: cub3r-mesh [file...]
+ *
+ * Imports each q3d file, resources/models/cub3.q3d and plane.q3d if none is given, and for every
+ * mesh reports how many vertices welding leaves of the exported triangle list, and the average
+ * cache miss ratio (ACMR) of the triangles as exported and after optimizing for the vertex cache.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/Importer.hpp"
+#include "../include/MeshOptimizer.hpp"
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> paths(argv + 1, argv + argc);
+    if(paths.empty())
+    {
+        paths.push_back("resources/models/cub3.q3d");
+        paths.push_back("resources/models/plane.q3d");
+    }
+
+    std::cout << std::left << std::setw(28) << "mesh" << std::right << std::setw(10) << "triangles"
+              << std::setw(10) << "exported" << std::setw(10) << "welded" << std::setw(10) << "ACMR"
+              << std::setw(10) << "optimized" << '\n';
+    for(const std::string& path : paths)
+    {
+        Importer importer(path, false);
+        std::vector<Importer::Mesh> objects = importer.getObjects();
+        unsigned int exportedTotal = 0;
+        unsigned int weldedTotal = 0;
+        for(Importer::Mesh& mesh : objects)
+        {
+            int exported = mesh.vsSize;
+            Importer::weld(mesh);
+            double before = MeshOptimizer::acmr(mesh.indices);
+            Importer::optimize(mesh);
+            double after = MeshOptimizer::acmr(mesh.indices);
+
+            std::cout << std::left << std::setw(28) << mesh.name << std::right
+                      << std::setw(10) << mesh.indices.size() / 3 << std::setw(10) << exported
+                      << std::setw(10) << mesh.vsSize << std::fixed << std::setprecision(3)
+                      << std::setw(10) << before << std::setw(10) << after << '\n';
+            exportedTotal += exported;
+            weldedTotal += mesh.vsSize;
+        }
+        std::cout << path << ": " << objects.size() << " meshes, " << exportedTotal << " vertices welded to "
+                  << weldedTotal << " (" << std::setprecision(1)
+                  << (exportedTotal > 0 ? 100.0 * (exportedTotal - weldedTotal) / exportedTotal : 0.0) << "% fewer)\n\n";
+    }
+    return 0;
+}
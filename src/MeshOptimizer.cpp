@@ -0,0 +1,199 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cmath>
+#include "../include/MeshOptimizer.hpp"
+
+namespace {
+
+// Scoring from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", 2006
+const float CACHE_DECAY_POWER   = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f; // For the vertices of the triangle just drawn
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+
+const unsigned int MAX_VALENCE = 64; // Triangles per vertex the valence boost is tabulated for
+
+/**
+ * Score tables, by position in the LRU cache and by the number of triangles still to be drawn
+ * that use a vertex.
+ */
+struct Scores
+{
+    float cache[MeshOptimizer::CACHE_SIZE];
+    float valence[MAX_VALENCE];
+
+    Scores()
+    {
+        for(unsigned int i = 0; i < MeshOptimizer::CACHE_SIZE; ++i)
+        {
+            // The last triangle's vertices score the same, or the order it was drawn in would matter
+            cache[i] = i < 3 ? LAST_TRIANGLE_SCORE
+                             : std::pow(1.0f - (float)(i - 3) / (MeshOptimizer::CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        valence[0] = 0.0f;
+        for(unsigned int i = 1; i < MAX_VALENCE; ++i)
+        {
+            // Boost vertices with few triangles left, so lone triangles are not left stranded
+            valence[i] = VALENCE_BOOST_SCALE * std::pow((float)i, -VALENCE_BOOST_POWER);
+        }
+    }
+
+    float score(int cachePosition, unsigned int remaining) const
+    {
+        if(remaining == 0)
+        {
+            return -1.0f; // No triangle left to use it
+        }
+        float score = cachePosition < 0 ? 0.0f : cache[cachePosition];
+        return score + valence[std::min(remaining, MAX_VALENCE - 1)];
+    }
+};
+
+} // namespace
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount)
+{
+    static const Scores scores;
+    unsigned int triangleCount = indices.size() / 3;
+
+    // The triangles using each vertex, those still to be drawn first
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for(unsigned int index : indices)
+    {
+        ++remaining[index];
+    }
+    std::vector<unsigned int> firstTriangle(vertexCount + 1, 0);
+    for(unsigned int v = 0; v < vertexCount; ++v)
+    {
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+    }
+    std::vector<unsigned int> vertexTriangles(indices.size());
+    std::vector<unsigned int> filled(firstTriangle.begin(), firstTriangle.end() - 1);
+    for(unsigned int i = 0; i < indices.size(); ++i)
+    {
+        vertexTriangles[filled[indices[i]]++] = i / 3;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for(unsigned int v = 0; v < vertexCount; ++v)
+    {
+        vertexScore[v] = scores.score(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    for(unsigned int t = 0; t < triangleCount; ++t)
+    {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> drawn(triangleCount, false);
+    std::vector<unsigned int> cache;  // Most recently used first; three over size while updating
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    unsigned int nextUndrawn = 0; // Where to look when no triangle in the cache is left
+    int best = triangleCount > 0 ? 0 : -1;
+    while(best >= 0)
+    {
+        drawn[best] = true;
+        std::vector<unsigned int> updated(indices.begin() + best * 3, indices.begin() + best * 3 + 3);
+        for(unsigned int v : updated)
+        {
+            output.push_back(v);
+            --remaining[v];
+            // Move the drawn triangle to the back of the vertex's list, out of the remaining ones
+            unsigned int* begin = &vertexTriangles[firstTriangle[v]];
+            std::swap(*std::find(begin, begin + remaining[v] + 1, (unsigned int)best), begin[remaining[v]]);
+        }
+        for(int i = 2; i >= 0; --i)
+        {
+            std::vector<unsigned int>::iterator cached = std::find(cache.begin(), cache.end(), updated[i]);
+            if(cached != cache.end())
+            {
+                cache.erase(cached);
+            }
+            cache.insert(cache.begin(), updated[i]);
+        }
+        for(unsigned int i = 0; i < cache.size(); ++i)
+        {
+            cachePosition[cache[i]] = i < CACHE_SIZE ? (int)i : -1;
+        }
+        if(cache.size() > CACHE_SIZE)
+        {
+            // The vertices pushed out still need rescoring, as do their triangles
+            updated.insert(updated.end(), cache.begin() + CACHE_SIZE, cache.end());
+            cache.resize(CACHE_SIZE);
+        }
+        updated.insert(updated.end(), cache.begin(), cache.end());
+
+        for(unsigned int v : updated)
+        {
+            vertexScore[v] = scores.score(cachePosition[v], remaining[v]);
+        }
+        best = -1;
+        float bestScore = -1.0f;
+        for(unsigned int v : updated)
+        {
+            for(unsigned int i = firstTriangle[v]; i < firstTriangle[v] + remaining[v]; ++i)
+            {
+                unsigned int t = vertexTriangles[i];
+                triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]]
+                                 + vertexScore[indices[t * 3 + 2]];
+                if(triangleScore[t] > bestScore)
+                {
+                    best = t;
+                    bestScore = triangleScore[t];
+                }
+            }
+        }
+        if(best < 0)
+        {
+            while(nextUndrawn < triangleCount && drawn[nextUndrawn])
+            {
+                ++nextUndrawn;
+            }
+            best = nextUndrawn < triangleCount ? (int)nextUndrawn : -1;
+        }
+    }
+    indices.swap(output);
+}
+
+double MeshOptimizer::acmr(const std::vector<unsigned int>& indices, unsigned int cacheSize)
+{
+    if(indices.empty())
+    {
+        return 0.0;
+    }
+    std::vector<unsigned int> fifo;
+    unsigned int misses = 0;
+    for(unsigned int index : indices)
+    {
+        if(std::find(fifo.begin(), fifo.end(), index) == fifo.end())
+        {
+            ++misses;
+            fifo.push_back(index);
+            if(fifo.size() > cacheSize)
+            {
+                fifo.erase(fifo.begin());
+            }
+        }
+    }
+    return (double)misses / (indices.size() / 3);
+}
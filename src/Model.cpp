@@ -17,19 +17,44 @@
   along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cstddef>
 #include <iostream>
 #include <fstream>
 #include <math.h>
-#include <SDL2/SDL_image.h>
 #include "../include/Model.hpp"
 
-Model::Model() {}
+namespace {
+
+/**
+ * A vertex as laid out in the vertex buffer.
+ */
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 uv; // Texture coordinates and the texture array layer
+};
+
+} // namespace
+
+Model::Model() :
+transformChanged{true},
+transformUpdates{0},
+currentSlerpVal{0.0f}
+{}
 
 Model::Model(std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& normals, std::vector<glm::vec2>& uvs,
-             std::string texturePath, GLuint vCount, GLuint shader, GLfloat shininess, bool dynamicDraw) :
+             std::vector<GLuint>& indices, GLfloat textureLayer, GLuint shader, GLfloat shininess, bool dynamicDraw) :
 shaderProgram{shader},
-vertexCount{vCount},
-materialShininess{shininess}
+indexCount{(GLuint)indices.size()},
+mvpMatrixLocation{glGetUniformLocation(shader, "modelViewProjectionMatrix")},
+modelMatrixLocation{glGetUniformLocation(shader, "modelTransformMatrix")},
+normalMatrixLocation{glGetUniformLocation(shader, "normalMatrix")},
+shininessLocation{glGetUniformLocation(shader, "materialShininess")},
+materialShininess{shininess},
+transformChanged{true},
+transformUpdates{0},
+currentSlerpVal{0.0f}
 {
     GLenum usage = GL_STATIC_DRAW;
     if(dynamicDraw)
@@ -37,10 +62,7 @@ materialShininess{shininess}
         usage = GL_DYNAMIC_DRAW;
     }
 
-    createVBO(VBOposition, vertices, usage);
-    createVBO(VBOnormal, normals, usage);
-    createUVBuffer(VBOuv, uvs, usage);
-    createTexture(texturePath);
+    createVertexArrays(vertices, normals, uvs, indices, textureLayer, usage);
 }
 
 Model::~Model() {}
@@ -48,11 +70,13 @@ Model::~Model() {}
 void Model::scale(glm::vec3 amount)
 {
     modelScaleMatrix = glm::scale(modelScaleMatrix, amount);
+    transformChanged = true;
 }
 
 void Model::translate(glm::vec3 amount)
 {
     modelTranslateMatrix = glm::translate(modelTranslateMatrix, amount);
+    transformChanged = true;
 }
 
 void Model::localRotate(GLfloat angle, glm::vec3 axis, GLfloat slerp)
@@ -65,48 +89,24 @@ void Model::worldRotate(GLfloat angle, glm::vec3 axis, GLfloat slerp)
     rotate(modelWorldRotateMatrix, angle, axis, slerp);
 }
 
-void Model::renderShadowMap(GLuint shadowProgram)
+void Model::render(glm::mat4 viewProjectionMatrix)
 {
-    //glViewport(0, 0, 1200, 1000);
-
-    GLint modelMatrixLocation = glGetUniformLocation(shadowProgram, "modelMatrix");
-    glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &modelMatrix[0][0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBOposition);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-}
-
-void Model::render(glm::mat4 viewProjectionMatrix, glm::mat4 depthBiasMVP)
-{
-    GLint mvpMatrixLocation = glGetUniformLocation(shaderProgram, "modelViewProjectionMatrix");
-    glm::mat4 modelViewProjectionMatrix = viewProjectionMatrix * modelMatrix;
+    if(updateTransform() || viewProjectionMatrix != lastViewProjectionMatrix)
+    {
+        lastViewProjectionMatrix = viewProjectionMatrix;
+        modelViewProjectionMatrix = viewProjectionMatrix * modelMatrix;
+        ++transformUpdates;
+    }
     glUniformMatrix4fv(mvpMatrixLocation, 1, GL_FALSE, &modelViewProjectionMatrix[0][0]);
 
-    GLint modelMatrixLocation = glGetUniformLocation(shaderProgram, "modelTransformMatrix");
     glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &modelMatrix[0][0]);
 
-    glm::mat3 normalMatrix = glm::inverse(glm::mat3(modelMatrix));
-    GLint normalMatrixLocation = glGetUniformLocation(shaderProgram, "normalMatrix");
     glUniformMatrix3fv(normalMatrixLocation, 1, GL_TRUE, &normalMatrix[0][0]);
 
-    GLint shininess = glGetUniformLocation(shaderProgram, "materialShininess");
-    glUniform1f(shininess, materialShininess);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBOposition);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBOnormal);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    GLint textureID = glGetUniformLocation(shaderProgram, "textureSampler");
-    glUniform1i(textureID, 1);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOuv);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glUniform1f(shininessLocation, materialShininess);
 
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
 }
 
 void Model::operations()
@@ -115,42 +115,45 @@ void Model::operations()
     {
         doRotation();
     }
-    modelMatrix = modelScaleMatrix * modelWorldRotateMatrix * modelTranslateMatrix * modelLocalRotateMatrix;
-}
-
-void Model::createVBO(GLuint& VBO, std::vector<glm::vec3> data, GLenum usage)
-{
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(glm::vec3), &data[0], usage);
 }
 
-void Model::createUVBuffer(GLuint& VBOuv, std::vector<glm::vec2> data, GLenum usage)
+unsigned long Model::getTransformUpdates() const
 {
-    glGenBuffers(1, &VBOuv);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOuv);
-    glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(glm::vec2), &data[0], usage);
+    return transformUpdates;
 }
 
-void Model::createTexture(std::string filePath)
+void Model::createVertexArrays(std::vector<glm::vec3>& vertices, std::vector<glm::vec3>& normals,
+                               std::vector<glm::vec2>& uvs, std::vector<GLuint>& indices,
+                               GLfloat textureLayer, GLenum usage)
 {
-    SDL_Surface* image = IMG_Load(filePath.c_str());
-    if(image == NULL)
+    std::vector<Vertex> interleaved(vertices.size());
+    for(GLuint i = 0; i < vertices.size(); ++i)
     {
-        std::cout << "Could not load image! SDL_image Error: " << filePath.c_str() << ' ' << IMG_GetError() << '\n';
+        interleaved[i].position = vertices[i];
+        interleaved[i].normal = normals[i];
+        interleaved[i].uv = glm::vec3(uvs[i], textureLayer);
     }
-
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image->w, image->h,
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, image->pixels);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    SDL_FreeSurface(image);
+    glGenBuffers(1, &VBOvertex);
+    glBindBuffer(GL_ARRAY_BUFFER, VBOvertex);
+    glBufferData(GL_ARRAY_BUFFER, interleaved.size() * sizeof(Vertex), &interleaved[0], usage);
+
+    // The element buffer binding is part of the vertex array object's state
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, uv));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
 }
 
-void Model::generateVertexNormals(std::vector<glm::vec3> vertices, std::vector<GLuint> indices, GLenum usage)
+std::vector<glm::vec3> Model::generateVertexNormals(std::vector<glm::vec3> vertices, std::vector<GLuint> indices)
 {
     std::vector<glm::vec3> normals;
     for(GLuint i = 0; i < vertices.size(); ++i)
@@ -168,7 +171,7 @@ void Model::generateVertexNormals(std::vector<glm::vec3> vertices, std::vector<G
         normals[indices[i * 3 + 1]] += faceNormal;
         normals[indices[i * 3 + 2]] += faceNormal;
     }
-    createVBO(VBOnormal, normals, usage);
+    return normals;
 }
 
 void Model::rotate(glm::mat4& rotateMatrix, GLfloat angle, glm::vec3 axis, GLfloat slerp)
@@ -185,6 +188,7 @@ void Model::rotate(glm::mat4& rotateMatrix, GLfloat angle, glm::vec3 axis, GLflo
     glm::quat target = glm::normalize(glm::angleAxis(angle, axis)) * glm::quat_cast(currentModelWorldRotateMatrix);
     glm::quat mix = glm::mix(glm::quat_cast(currentModelWorldRotateMatrix), target, slerp);
     rotateMatrix = glm::mat4_cast(mix);
+    transformChanged = true;
 
     if(currentSlerpVal == 1.0f)
     {
@@ -212,4 +216,17 @@ bool Model::isRotating()
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+bool Model::updateTransform()
+{
+    if(!transformChanged)
+    {
+        return false;
+    }
+    modelMatrix = modelScaleMatrix * modelWorldRotateMatrix * modelTranslateMatrix * modelLocalRotateMatrix;
+    normalMatrix = glm::inverse(glm::mat3(modelMatrix));
+    transformChanged = false;
+    transformUpdates += 2;
+    return true;
+}
@@ -0,0 +1,372 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include "../include/NxNCubeState.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const int TILE = 16; // Side of the tiles a face is transposed in
+
+/**
+ * Where a strip starts on its face, in terms of the layer being turned.
+ */
+enum Offset { ZERO, LAST, LAYER, LAST_LAYER };
+
+/**
+ * A row or column of stickers that a turn carries to another face, given by its first sticker
+ * and the step to the next one.
+ */
+struct Strip
+{
+    int face;
+    Offset row;
+    Offset column;
+    int rowStep;
+    int columnStep;
+};
+
+/**
+ * For each face, the four strips a clockwise turn of one of its layers moves, each to the next
+ * and the last to the first. Stickers with the same index along their strips move together.
+ */
+const Strip STRIPS[CubeState::N_FACES][4] = {
+    {{CubeState::F, LAYER, ZERO, 0, 1}, {CubeState::L, LAYER, ZERO, 0, 1},
+     {CubeState::B, LAYER, ZERO, 0, 1}, {CubeState::R, LAYER, ZERO, 0, 1}},
+    {{CubeState::F, LAST, LAST_LAYER, -1, 0}, {CubeState::U, LAST, LAST_LAYER, -1, 0},
+     {CubeState::B, ZERO, LAYER, 1, 0}, {CubeState::D, LAST, LAST_LAYER, -1, 0}},
+    {{CubeState::U, LAST_LAYER, ZERO, 0, 1}, {CubeState::R, ZERO, LAYER, 1, 0},
+     {CubeState::D, LAYER, LAST, 0, -1}, {CubeState::L, LAST, LAST_LAYER, -1, 0}},
+    {{CubeState::F, LAST_LAYER, ZERO, 0, 1}, {CubeState::R, LAST_LAYER, ZERO, 0, 1},
+     {CubeState::B, LAST_LAYER, ZERO, 0, 1}, {CubeState::L, LAST_LAYER, ZERO, 0, 1}},
+    {{CubeState::U, ZERO, LAYER, 1, 0}, {CubeState::F, ZERO, LAYER, 1, 0},
+     {CubeState::D, ZERO, LAYER, 1, 0}, {CubeState::B, LAST, LAST_LAYER, -1, 0}},
+    {{CubeState::U, LAYER, LAST, 0, -1}, {CubeState::L, ZERO, LAYER, 1, 0},
+     {CubeState::D, LAST_LAYER, ZERO, 0, 1}, {CubeState::R, LAST, LAST_LAYER, -1, 0}}
+};
+
+int offset(Offset o, int size, int layer)
+{
+    switch(o)
+    {
+        case LAST:
+            return size - 1;
+        case LAYER:
+            return layer;
+        case LAST_LAYER:
+            return size - 1 - layer;
+        default:
+            return 0;
+    }
+}
+
+void copyStrip(const uint8_t* from, int fromStep, uint8_t* to, int toStep, int count)
+{
+    if(fromStep == 1 && toStep == 1)
+    {
+        memcpy(to, from, count);
+        return;
+    }
+    for(int i = 0; i < count; ++i)
+    {
+        to[i * toStep] = from[i * fromStep];
+    }
+}
+
+void swapStrips(uint8_t* a, int aStep, uint8_t* b, int bStep, int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        std::swap(a[i * aStep], b[i * bStep]);
+    }
+}
+
+/**
+ * Reverse the order of the rows of a square plane, each moved whole through a row of scratch
+ * space.
+ */
+void reverseRows(uint8_t* plane, int size, uint8_t* scratch)
+{
+    for(int i = 0; i < size / 2; ++i)
+    {
+        uint8_t* top = plane + i * size;
+        uint8_t* bottom = plane + (size - 1 - i) * size;
+        memcpy(scratch, top, size);
+        memcpy(top, bottom, size);
+        memcpy(bottom, scratch, size);
+    }
+}
+
+#ifdef __SSE2__
+
+/**
+ * Reverse the 16 bytes of a register: the 32-bit words, then the 16-bit halves of each, then
+ * the bytes of each half.
+ */
+__m128i reverseBytes(__m128i bytes)
+{
+    bytes = _mm_shuffle_epi32(bytes, _MM_SHUFFLE(0, 1, 2, 3));
+    bytes = _mm_shufflelo_epi16(_mm_shufflehi_epi16(bytes, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_or_si128(_mm_slli_epi16(bytes, 8), _mm_srli_epi16(bytes, 8));
+}
+
+#endif // __SSE2__
+
+/**
+ * Reverse a run of bytes in place, with SSE2 16 at a time from both ends.
+ */
+void reverse(uint8_t* first, uint8_t* last)
+{
+#ifdef __SSE2__
+    while(last - first >= 2 * 16)
+    {
+        last -= 16;
+        __m128i front = _mm_loadu_si128((const __m128i*)first);
+        __m128i back = _mm_loadu_si128((const __m128i*)last);
+        _mm_storeu_si128((__m128i*)first, reverseBytes(back));
+        _mm_storeu_si128((__m128i*)last, reverseBytes(front));
+        first += 16;
+    }
+#endif
+    std::reverse(first, last);
+}
+
+#ifdef __SSE2__
+
+/**
+ * Load a 16 x 16 tile and transpose it in registers. Each round interleaves row i with row
+ * i + 8, which moves one bit of the column index into the row index; four rounds swap them.
+ */
+void loadTransposed(const uint8_t* tile, int stride, __m128i rows[TILE])
+{
+    __m128i other[TILE];
+    for(int i = 0; i < TILE; ++i)
+    {
+        other[i] = _mm_loadu_si128((const __m128i*)(tile + i * stride));
+    }
+    for(int round = 0; round < 2; ++round)
+    {
+        for(int i = 0; i < TILE / 2; ++i)
+        {
+            rows[2 * i] = _mm_unpacklo_epi8(other[i], other[i + TILE / 2]);
+            rows[2 * i + 1] = _mm_unpackhi_epi8(other[i], other[i + TILE / 2]);
+        }
+        for(int i = 0; i < TILE / 2; ++i)
+        {
+            other[2 * i] = _mm_unpacklo_epi8(rows[i], rows[i + TILE / 2]);
+            other[2 * i + 1] = _mm_unpackhi_epi8(rows[i], rows[i + TILE / 2]);
+        }
+    }
+    for(int i = 0; i < TILE; ++i)
+    {
+        rows[i] = other[i];
+    }
+}
+
+void storeTile(uint8_t* tile, int stride, const __m128i rows[TILE])
+{
+    for(int i = 0; i < TILE; ++i)
+    {
+        _mm_storeu_si128((__m128i*)(tile + i * stride), rows[i]);
+    }
+}
+
+#endif // __SSE2__
+
+/**
+ * Transpose a square plane in place. With SSE2 the whole tiles are transposed in registers, a
+ * diagonal tile onto itself and the others swapped with their mirror images, leaving only the
+ * stickers past the last whole tile to swap one at a time.
+ */
+void transpose(uint8_t* plane, int size)
+{
+    int tiled = 0;
+#ifdef __SSE2__
+    tiled = size / TILE * TILE;
+    __m128i a[TILE];
+    __m128i b[TILE];
+    for(int i = 0; i < tiled; i += TILE)
+    {
+        uint8_t* diagonal = plane + i * size + i;
+        loadTransposed(diagonal, size, a);
+        storeTile(diagonal, size, a);
+        for(int j = i + TILE; j < tiled; j += TILE)
+        {
+            uint8_t* upper = plane + i * size + j;
+            uint8_t* lower = plane + j * size + i;
+            loadTransposed(upper, size, a);
+            loadTransposed(lower, size, b);
+            storeTile(lower, size, a);
+            storeTile(upper, size, b);
+        }
+    }
+#endif
+    for(int i = 0; i < size; ++i)
+    {
+        for(int j = std::max(i + 1, tiled); j < size; ++j)
+        {
+            std::swap(plane[i * size + j], plane[j * size + i]);
+        }
+    }
+}
+
+} // namespace
+
+NxNCubeState::NxNCubeState(int size) :
+size(size),
+stickers(CubeState::N_FACES * size * size),
+strip(size)
+{
+    for(int f = 0; f < CubeState::N_FACES; ++f)
+    {
+        memset(face(f), f, size * size);
+    }
+}
+
+void NxNCubeState::turn(int f, int layer, int turns)
+{
+    turns &= 3;
+    if(turns == 0)
+    {
+        return;
+    }
+
+    uint8_t* starts[4];
+    int steps[4];
+    for(int j = 0; j < 4; ++j)
+    {
+        const Strip& s = STRIPS[f][j];
+        starts[j] = face(s.face) + offset(s.row, size, layer) * size + offset(s.column, size, layer);
+        steps[j] = s.rowStep * size + s.columnStep;
+    }
+
+    if(turns == 2)
+    {
+        swapStrips(starts[0], steps[0], starts[2], steps[2], size);
+        swapStrips(starts[1], steps[1], starts[3], steps[3], size);
+    }
+    else if(turns == 1)
+    {
+        copyStrip(starts[3], steps[3], strip.data(), 1, size);
+        for(int j = 3; j > 0; --j)
+        {
+            copyStrip(starts[j - 1], steps[j - 1], starts[j], steps[j], size);
+        }
+        copyStrip(strip.data(), 1, starts[0], steps[0], size);
+    }
+    else
+    {
+        copyStrip(starts[0], steps[0], strip.data(), 1, size);
+        for(int j = 0; j < 3; ++j)
+        {
+            copyStrip(starts[j + 1], steps[j + 1], starts[j], steps[j], size);
+        }
+        copyStrip(strip.data(), 1, starts[3], steps[3], size);
+    }
+
+    if(layer == 0)
+    {
+        rotateFace(f, turns);
+    }
+    if(layer == size - 1)
+    {
+        // Clockwise from this face is anticlockwise from the opposite one
+        rotateFace((f + 3) % CubeState::N_FACES, 4 - turns);
+    }
+}
+
+void NxNCubeState::apply(int move)
+{
+    turn(move / 3, 0, move % 3 + 1);
+}
+
+int NxNCubeState::getSize() const
+{
+    return size;
+}
+
+int NxNCubeState::getSticker(int f, int row, int column) const
+{
+    return getFace(f)[row * size + column];
+}
+
+void NxNCubeState::setSticker(int f, int row, int column, int colour)
+{
+    face(f)[row * size + column] = colour;
+}
+
+const uint8_t* NxNCubeState::getFace(int f) const
+{
+    return stickers.data() + (size_t)f * size * size;
+}
+
+bool NxNCubeState::isSolved() const
+{
+    for(int f = 0; f < CubeState::N_FACES; ++f)
+    {
+        const uint8_t* plane = getFace(f);
+        if(std::count(plane, plane + size * size, plane[0]) != size * size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NxNCubeState::operator==(const NxNCubeState& other) const
+{
+    return size == other.size && stickers == other.stickers;
+}
+
+bool NxNCubeState::operator!=(const NxNCubeState& other) const
+{
+    return !(*this == other);
+}
+
+uint8_t* NxNCubeState::face(int f)
+{
+    return stickers.data() + (size_t)f * size * size;
+}
+
+void NxNCubeState::rotateFace(int f, int turns)
+{
+    // A clockwise quarter turn takes row r, column c to row c, column size - 1 - r: the rows
+    // reversed and then transposed
+    uint8_t* plane = face(f);
+    if(turns == 1)
+    {
+        reverseRows(plane, size, strip.data());
+        transpose(plane, size);
+    }
+    else if(turns == 2)
+    {
+        reverse(plane, plane + size * size);
+    }
+    else
+    {
+        transpose(plane, size);
+        reverseRows(plane, size, strip.data());
+    }
+}
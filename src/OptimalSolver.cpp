@@ -0,0 +1,664 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "../include/OptimalSolver.hpp"
+#include "../include/Coordinates.hpp"
+#include "../include/PatternDatabase.hpp"
+#include "../include/Symmetry.hpp"
+#include "../include/TableFile.hpp"
+
+namespace {
+
+const int N_MOVES = CubeState::N_MOVES;
+const int EDGE_GROUP = 6;                                  // Edges in each edge database
+const uint64_t N_EDGE_POSITIONS = 665280;                  // 12! / 6! placements of a group
+const int N_CORNER_CLASSES = 2768;                         // Corner permutations up to the U-D symmetries
+const uint64_t N_CORNER_ENTRIES = (uint64_t)N_CORNER_CLASSES * Coordinates::N_TWIST; // Class x twist
+const uint64_t N_EDGE_ENTRIES = N_EDGE_POSITIONS << EDGE_GROUP; // Placement x flips
+const uint64_t FLUSH_NODES = 1 << 16;                      // Nodes a thread counts before adding to the total
+const char* TABLE_FILE = "resources/tables/optimal.tbl";
+
+struct Tables
+{
+    const uint8_t* corners;   // All eight corners, one entry per symmetry class
+    const uint8_t* edgesLow;  // Edges UR, UF, UL, UB, DR, DF
+    const uint8_t* edgesHigh; // Edges DL, DB, FR, FL, BL, BR
+
+    const uint16_t* cornerClass;          // Class of each corner permutation
+    const uint8_t* cornerSymmetry;        // Symmetry taking each permutation to its representative
+    const uint32_t* cornerRepresentative; // Representative permutation of each class
+    const uint16_t* twistConjugate;       // Twist conjugated by each U-D symmetry
+
+    // Where a move takes the edge at each position, and whether it flips it
+    int edgeDestination[N_MOVES][CubeState::N_EDGES];
+    int edgeFlip[N_MOVES][CubeState::N_EDGES];
+};
+
+// Backs the databases when they are built rather than mapped from the table file
+struct Storage
+{
+    std::vector<uint8_t> corners;
+    std::vector<uint8_t> edgesLow;
+    std::vector<uint8_t> edgesHigh;
+    std::vector<uint16_t> cornerClass;
+    std::vector<uint8_t> cornerSymmetry;
+    std::vector<uint32_t> cornerRepresentative;
+    std::vector<uint16_t> twistConjugate;
+};
+
+Tables tables;
+Storage storage;
+TableFile file;
+
+/**
+ * Rank of the placement of a group of six edges, as mixed radix digits 12, 11, ..., 7. Each
+ * digit is the position less the number of lower positions already taken.
+ */
+inline uint64_t rankPlacement(const int* positions)
+{
+    unsigned int used = 0;
+    uint64_t rank = 0;
+    for(int i = 0; i < EDGE_GROUP; ++i)
+    {
+        int lower = __builtin_popcount(used & ((1u << positions[i]) - 1));
+        rank = rank * (CubeState::N_EDGES - i) + positions[i] - lower;
+        used |= 1u << positions[i];
+    }
+    return rank;
+}
+
+inline void unrankPlacement(uint64_t rank, int* positions)
+{
+    int digits[EDGE_GROUP];
+    for(int i = EDGE_GROUP - 1; i >= 0; --i)
+    {
+        digits[i] = (int)(rank % (CubeState::N_EDGES - i));
+        rank /= CubeState::N_EDGES - i;
+    }
+    unsigned int used = 0;
+    for(int i = 0; i < EDGE_GROUP; ++i)
+    {
+        int position = 0;
+        for(int skip = digits[i]; skip > 0 || (used & (1u << position)); ++position)
+        {
+            if(!(used & (1u << position)))
+            {
+                --skip;
+            }
+        }
+        positions[i] = position;
+        used |= 1u << position;
+    }
+}
+
+/**
+ * Corner database index of a corner permutation and twist. The state is conjugated by the
+ * symmetry that takes its permutation to the representative of its class; the twist can be
+ * conjugated on its own because the U-D symmetries twist every corner alike.
+ */
+inline uint64_t symmetricCornerIndex(int permutation, int twist)
+{
+    int symmetry = tables.cornerSymmetry[permutation];
+    return (uint64_t)tables.cornerClass[permutation] * Coordinates::N_TWIST
+         + tables.twistConjugate[twist * Symmetry::N_UD_SYMMETRIES + symmetry];
+}
+
+inline uint64_t cornerIndex(const CubeState& state)
+{
+    unsigned int used = 0;
+    int rank = 0;
+    int twist = 0;
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        int corner = state.cornerPermutation(i);
+        rank = rank * (CubeState::N_CORNERS - i) + corner - __builtin_popcount(used & ((1u << corner) - 1));
+        used |= 1u << corner;
+        if(i < CubeState::N_CORNERS - 1)
+        {
+            twist = twist * 3 + state.cornerOrientation(i);
+        }
+    }
+    return symmetricCornerIndex(rank, twist);
+}
+
+/**
+ * Corner index of the inverse state, without building the inverse.
+ */
+inline uint64_t dualCornerIndex(const CubeState& state)
+{
+    int permutation[CubeState::N_CORNERS];
+    int twist[CubeState::N_CORNERS];
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        int corner = state.cornerPermutation(i);
+        permutation[corner] = i;
+        twist[corner] = (3 - state.cornerOrientation(i)) % 3;
+    }
+
+    unsigned int used = 0;
+    int rank = 0;
+    int twistRank = 0;
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        int corner = permutation[i];
+        rank = rank * (CubeState::N_CORNERS - i) + corner - __builtin_popcount(used & ((1u << corner) - 1));
+        used |= 1u << corner;
+        if(i < CubeState::N_CORNERS - 1)
+        {
+            twistRank = twistRank * 3 + twist[i];
+        }
+    }
+    return symmetricCornerIndex(rank, twistRank);
+}
+
+inline uint64_t edgeIndex(const CubeState& state, int first)
+{
+    int positions[EDGE_GROUP];
+    int flips = 0;
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        unsigned int k = state.edgePermutation(i) - first;
+        if(k < (unsigned int)EDGE_GROUP)
+        {
+            positions[k] = i;
+            flips |= state.edgeOrientation(i) << (EDGE_GROUP - 1 - k);
+        }
+    }
+    return (rankPlacement(positions) << EDGE_GROUP) | flips;
+}
+
+/**
+ * Edge index of the inverse state. In the inverse, edge k of the group sits where the state
+ * has the edge that belongs at position k, with the same flip.
+ */
+inline uint64_t dualEdgeIndex(const CubeState& state, int first)
+{
+    int positions[EDGE_GROUP];
+    int flips = 0;
+    for(int k = 0; k < EDGE_GROUP; ++k)
+    {
+        positions[k] = state.edgePermutation(first + k);
+        flips |= state.edgeOrientation(first + k) << (EDGE_GROUP - 1 - k);
+    }
+    return (rankPlacement(positions) << EDGE_GROUP) | flips;
+}
+
+/**
+ * Build the symmetry classes of the corner permutation and the twist conjugation table the
+ * corner database is indexed through.
+ */
+void buildCornerSymmetries()
+{
+    Symmetry::buildClasses(Coordinates::N_CORNER_PERM, Coordinates::getCornerPermutation,
+                           Coordinates::setCornerPermutation, storage.cornerClass, storage.cornerSymmetry,
+                           storage.cornerRepresentative);
+    Symmetry::buildConjugationTable(storage.twistConjugate, Coordinates::N_TWIST, Coordinates::getTwist,
+                                    Coordinates::setTwist);
+    tables.cornerClass = storage.cornerClass.data();
+    tables.cornerSymmetry = storage.cornerSymmetry.data();
+    tables.cornerRepresentative = storage.cornerRepresentative.data();
+    tables.twistConjugate = storage.twistConjugate.data();
+}
+
+void buildCornerDatabase()
+{
+    int allMoves[N_MOVES];
+    for(int m = 0; m < N_MOVES; ++m)
+    {
+        allMoves[m] = m;
+    }
+    std::vector<uint16_t> permutationMove;
+    std::vector<uint16_t> twistMove;
+    Coordinates::buildMoveTable(permutationMove, Coordinates::N_CORNER_PERM, Coordinates::getCornerPermutation,
+                                Coordinates::setCornerPermutation, allMoves, N_MOVES);
+    Coordinates::buildMoveTable(twistMove, Coordinates::N_TWIST, Coordinates::getTwist,
+                                Coordinates::setTwist, allMoves, N_MOVES);
+
+    // Symmetries that leave the representative permutation of each class unchanged. A state
+    // whose permutation has such a symmetry shares its class with the conjugates of its twist,
+    // so every move leads to all of their entries
+    std::vector<uint16_t> stabiliser(N_CORNER_CLASSES, 0);
+    for(int c = 0; c < N_CORNER_CLASSES; ++c)
+    {
+        CubeState state;
+        Coordinates::setCornerPermutation(state, tables.cornerRepresentative[c]);
+        for(int s = 0; s < Symmetry::N_UD_SYMMETRIES; ++s)
+        {
+            if(Coordinates::getCornerPermutation(Symmetry::conjugate(state, s)) == (int)tables.cornerRepresentative[c])
+            {
+                stabiliser[c] |= 1 << s;
+            }
+        }
+    }
+
+    // An entry stands for the representative permutation with its twist
+    PatternDatabase::build(storage.corners, N_CORNER_ENTRIES, 0, [&](uint64_t index, uint64_t* next) -> int
+    {
+        int permutation = (int)tables.cornerRepresentative[index / Coordinates::N_TWIST];
+        int twist = (int)(index % Coordinates::N_TWIST);
+        int count = 0;
+        for(int m = 0; m < N_MOVES; ++m)
+        {
+            uint64_t moved = symmetricCornerIndex(permutationMove[permutation * N_MOVES + m], twistMove[twist * N_MOVES + m]);
+            uint64_t base = moved - moved % Coordinates::N_TWIST;
+            int movedTwist = (int)(moved % Coordinates::N_TWIST);
+            int symmetries = stabiliser[moved / Coordinates::N_TWIST];
+            for(int s = 0; s < Symmetry::N_UD_SYMMETRIES; ++s)
+            {
+                if(symmetries >> s & 1)
+                {
+                    next[count++] = base + tables.twistConjugate[movedTwist * Symmetry::N_UD_SYMMETRIES + s];
+                }
+            }
+        }
+        return count;
+    });
+}
+
+void buildEdgeDatabase(std::vector<uint8_t>& table, int first)
+{
+    CubeState solved;
+    PatternDatabase::build(table, N_EDGE_ENTRIES, edgeIndex(solved, first), [](uint64_t index, uint64_t* next) -> int
+    {
+        int positions[EDGE_GROUP];
+        int moved[EDGE_GROUP];
+        unrankPlacement(index >> EDGE_GROUP, positions);
+        int flips = (int)(index & ((1 << EDGE_GROUP) - 1));
+        for(int m = 0; m < N_MOVES; ++m)
+        {
+            int movedFlips = flips;
+            for(int k = 0; k < EDGE_GROUP; ++k)
+            {
+                moved[k] = tables.edgeDestination[m][positions[k]];
+                movedFlips ^= tables.edgeFlip[m][positions[k]] << (EDGE_GROUP - 1 - k);
+            }
+            next[m] = (rankPlacement(moved) << EDGE_GROUP) | movedFlips;
+        }
+        return N_MOVES;
+    });
+}
+
+/**
+ * Point the databases at the table file, if it exists and holds all of them.
+ */
+bool mapTables()
+{
+    if(!file.open(TABLE_FILE))
+    {
+        return false;
+    }
+    tables.corners = (const uint8_t*)file.getTable("corners", (N_CORNER_ENTRIES + 1) / 2);
+    tables.edgesLow = (const uint8_t*)file.getTable("edgesLow", (N_EDGE_ENTRIES + 1) / 2);
+    tables.edgesHigh = (const uint8_t*)file.getTable("edgesHigh", (N_EDGE_ENTRIES + 1) / 2);
+    tables.cornerClass = (const uint16_t*)file.getTable("cornerClass", Coordinates::N_CORNER_PERM * sizeof(uint16_t));
+    tables.cornerSymmetry = (const uint8_t*)file.getTable("cornerSymmetry", Coordinates::N_CORNER_PERM);
+    tables.cornerRepresentative = (const uint32_t*)file.getTable("cornerRepresentative",
+                                                                 N_CORNER_CLASSES * sizeof(uint32_t));
+    tables.twistConjugate = (const uint16_t*)file.getTable("twistConjugate",
+                                                           Coordinates::N_TWIST * Symmetry::N_UD_SYMMETRIES * sizeof(uint16_t));
+    return tables.corners != nullptr && tables.edgesLow != nullptr && tables.edgesHigh != nullptr &&
+           tables.cornerClass != nullptr && tables.cornerSymmetry != nullptr &&
+           tables.cornerRepresentative != nullptr && tables.twistConjugate != nullptr;
+}
+
+
+/**
+ * Generate the children of a node and keep those the databases cannot rule out within togo
+ * moves. The entries of every child are prefetched before any of them is looked up, so the
+ * cache misses of all children overlap.
+ *
+ * @param symmetries The symmetries of the root state when expanding the root, otherwise 0
+ * @return the number of children kept
+ */
+int expand(const CubeState& state, int previous, uint64_t symmetries, int togo, CubeState* children, int* childMoves,
+           uint64_t& generated)
+{
+    uint64_t corner[N_MOVES];
+    uint64_t edgeLow[N_MOVES];
+    uint64_t edgeHigh[N_MOVES];
+    int count = 0;
+    uint32_t following = CubeState::followingMoves(previous);
+    for(int m = 0; m < N_MOVES; ++m)
+    {
+        if(!(following >> m & 1) || (symmetries != 0 && Symmetry::isDuplicateMove(m, symmetries)))
+        {
+            continue;
+        }
+        children[count] = state;
+        children[count].apply(m);
+        childMoves[count] = m;
+        corner[count]   = cornerIndex(children[count]);
+        edgeLow[count]  = edgeIndex(children[count], 0);
+        edgeHigh[count] = edgeIndex(children[count], EDGE_GROUP);
+        PatternDatabase::prefetch(tables.corners, corner[count]);
+        PatternDatabase::prefetch(tables.edgesLow, edgeLow[count]);
+        PatternDatabase::prefetch(tables.edgesHigh, edgeHigh[count]);
+        ++count;
+    }
+    generated += count;
+
+    int kept = 0;
+    for(int k = 0; k < count; ++k)
+    {
+        if(PatternDatabase::lookup(tables.corners, corner[k]) >= togo ||
+           PatternDatabase::lookup(tables.edgesLow, edgeLow[k]) >= togo ||
+           PatternDatabase::lookup(tables.edgesHigh, edgeHigh[k]) >= togo)
+        {
+            continue;
+        }
+        // The dual lookups only matter when the direct ones did not prune
+        if(PatternDatabase::lookup(tables.corners, dualCornerIndex(children[k])) >= togo ||
+           PatternDatabase::lookup(tables.edgesLow, dualEdgeIndex(children[k], 0)) >= togo ||
+           PatternDatabase::lookup(tables.edgesHigh, dualEdgeIndex(children[k], EDGE_GROUP)) >= togo)
+        {
+            continue;
+        }
+        children[kept] = children[k];
+        childMoves[kept] = childMoves[k];
+        ++kept;
+    }
+    return kept;
+}
+
+} // namespace
+
+const int OptimalSolver::MAX_SPLIT_DEPTH;
+
+OptimalSolver::OptimalSolver(int threads, int splitDepth) :
+splitDepth{std::max(1, std::min(splitDepth, MAX_SPLIT_DEPTH))},
+stop{false},
+nodes{0},
+symmetries{0},
+elapsed{0.0},
+cache{nullptr},
+cancelled{nullptr}
+{
+    initTables();
+    if(threads < 1)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.resize(threads);
+    if(threads > 1)
+    {
+        pool.reset(new WorkStealingPool(threads));
+    }
+}
+
+OptimalSolver::~OptimalSolver() {}
+
+double OptimalSolver::initTables()
+{
+    static std::once_flag built;
+    double seconds = 0.0;
+    std::call_once(built, [&seconds]()
+    {
+        auto begin = std::chrono::steady_clock::now();
+
+        for(int m = 0; m < N_MOVES; ++m)
+        {
+            CubeState state;
+            state.apply(m);
+            for(int i = 0; i < CubeState::N_EDGES; ++i)
+            {
+                tables.edgeDestination[m][state.edgePermutation(i)] = i;
+                tables.edgeFlip[m][state.edgePermutation(i)] = state.edgeOrientation(i);
+            }
+        }
+
+        if(mapTables())
+        {
+            // The databases are paged in as the search touches them
+            file.verifyInBackground();
+        }
+        else
+        {
+            buildCornerSymmetries();
+            buildCornerDatabase();
+            buildEdgeDatabase(storage.edgesLow, 0);
+            buildEdgeDatabase(storage.edgesHigh, EDGE_GROUP);
+            tables.corners = storage.corners.data();
+            tables.edgesLow = storage.edgesLow.data();
+            tables.edgesHigh = storage.edgesHigh.data();
+            TableFile::write(TABLE_FILE, {{"corners", tables.corners, storage.corners.size()},
+                                          {"edgesLow", tables.edgesLow, storage.edgesLow.size()},
+                                          {"edgesHigh", tables.edgesHigh, storage.edgesHigh.size()},
+                                          {"cornerClass", tables.cornerClass, storage.cornerClass.size() * sizeof(uint16_t)},
+                                          {"cornerSymmetry", tables.cornerSymmetry, storage.cornerSymmetry.size()},
+                                          {"cornerRepresentative", tables.cornerRepresentative,
+                                           storage.cornerRepresentative.size() * sizeof(uint32_t)},
+                                          {"twistConjugate", tables.twistConjugate,
+                                           storage.twistConjugate.size() * sizeof(uint16_t)}});
+        }
+
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    });
+    return seconds;
+}
+
+bool OptimalSolver::solve(const CubeState& state, std::vector<int>& solution, int maxLength)
+{
+    auto begin = std::chrono::steady_clock::now();
+    solution.clear();
+    nodes = 0;
+    stop = false;
+    symmetries = Symmetry::getSymmetries(state);
+
+    bool found = state.isSolved();
+    bool cached = !found && cache != nullptr && cache->lookup(SolutionCache::OPTIMAL, state, maxLength, solution);
+    found = found || cached;
+    maxLength = std::min(maxLength, MAX_DEPTH - 1);
+    for(int bound = estimate(state); !found && !isCancelled() && !file.isCorrupt() && bound <= maxLength; ++bound)
+    {
+        if(progress)
+        {
+            progress(bound, getNodeCount());
+        }
+        if(pool && bound > splitDepth)
+        {
+            // A cancelled search stops the threads too, but without a result
+            found = searchParallel(state, bound) && !isCancelled();
+            solution = result;
+        }
+        else
+        {
+            Worker& worker = workers[0];
+            worker.nodes = 0;
+            found = search(worker, state, 0, bound);
+            nodes += worker.nodes;
+            if(found)
+            {
+                solution.assign(worker.moves, worker.moves + bound);
+            }
+        }
+    }
+    // The tables may have failed verification while the search used them
+    if(found && !cached && file.isCorrupt())
+    {
+        found = false;
+        solution.clear();
+    }
+    if(found && !cached && cache != nullptr)
+    {
+        cache->insert(SolutionCache::OPTIMAL, state, solution);
+    }
+
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return found;
+}
+
+uint64_t OptimalSolver::getNodeCount() const
+{
+    return nodes.load(std::memory_order_relaxed);
+}
+
+double OptimalSolver::getElapsedSeconds() const
+{
+    return elapsed;
+}
+
+double OptimalSolver::getNodesPerSecond() const
+{
+    return elapsed > 0.0 ? getNodeCount() / elapsed : 0.0;
+}
+
+int OptimalSolver::getThreadCount() const
+{
+    return (int)workers.size();
+}
+
+void OptimalSolver::setCache(SolutionCache* cache)
+{
+    this->cache = cache;
+}
+
+void OptimalSolver::setProgress(Progress progress)
+{
+    this->progress = progress;
+}
+
+void OptimalSolver::setCancelFlag(const std::atomic<bool>* cancelled)
+{
+    this->cancelled = cancelled;
+}
+
+int OptimalSolver::estimate(const CubeState& state)
+{
+    int distance = PatternDatabase::lookup(tables.corners, cornerIndex(state));
+    distance = std::max(distance, PatternDatabase::lookup(tables.edgesLow, edgeIndex(state, 0)));
+    distance = std::max(distance, PatternDatabase::lookup(tables.edgesHigh, edgeIndex(state, EDGE_GROUP)));
+    distance = std::max(distance, PatternDatabase::lookup(tables.corners, dualCornerIndex(state)));
+    distance = std::max(distance, PatternDatabase::lookup(tables.edgesLow, dualEdgeIndex(state, 0)));
+    distance = std::max(distance, PatternDatabase::lookup(tables.edgesHigh, dualEdgeIndex(state, EDGE_GROUP)));
+    return distance;
+}
+
+bool OptimalSolver::searchParallel(const CubeState& state, int bound)
+{
+    std::vector<Subtree> subtrees;
+    Subtree root;
+    root.state = state;
+    split(root.state, 0, bound, subtrees);
+
+    // A thread that finds a solution stops the others; the tasks left after that return at once
+    result.clear();
+    std::vector<WorkStealingPool::Task> tasks;
+    tasks.reserve(subtrees.size());
+    for(const Subtree& subtree : subtrees)
+    {
+        tasks.push_back([this, &subtree, bound](int worker)
+        {
+            searchSubtree(workers[worker], subtree, bound);
+        });
+    }
+    pool->run(tasks);
+    return stop;
+}
+
+void OptimalSolver::split(const CubeState& state, int depth, int togo, std::vector<Subtree>& subtrees)
+{
+    // The search stack of the first worker holds the moves leading to the current node
+    Worker& worker = workers[0];
+    if(depth == splitDepth)
+    {
+        Subtree subtree;
+        subtree.state = state;
+        std::copy(worker.moves, worker.moves + depth, subtree.moves);
+        subtrees.push_back(subtree);
+        return;
+    }
+
+    CubeState children[N_MOVES];
+    int childMoves[N_MOVES];
+    uint64_t generated = 0;
+    int count = expand(state, depth > 0 ? worker.moves[depth - 1] : -1, depth == 0 ? symmetries : 0, togo, children,
+                       childMoves, generated);
+    nodes += generated;
+    for(int k = 0; k < count; ++k)
+    {
+        worker.moves[depth] = childMoves[k];
+        split(children[k], depth + 1, togo - 1, subtrees);
+    }
+}
+
+void OptimalSolver::searchSubtree(Worker& worker, const Subtree& subtree, int bound)
+{
+    if(stop.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    worker.nodes = 0;
+    std::copy(subtree.moves, subtree.moves + splitDepth, worker.moves);
+    if(search(worker, subtree.state, splitDepth, bound - splitDepth))
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if(!stop)
+        {
+            result.assign(worker.moves, worker.moves + bound);
+            stop = true;
+        }
+    }
+    nodes.fetch_add(worker.nodes, std::memory_order_relaxed);
+}
+
+bool OptimalSolver::search(Worker& worker, const CubeState& state, int depth, int togo)
+{
+    if(togo == 0)
+    {
+        return state.isSolved();
+    }
+    if(stop.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    CubeState children[N_MOVES];
+    int childMoves[N_MOVES];
+    int count = expand(state, depth > 0 ? worker.moves[depth - 1] : -1, depth == 0 ? symmetries : 0, togo, children,
+                       childMoves, worker.nodes);
+    if(worker.nodes >= FLUSH_NODES)
+    {
+        nodes.fetch_add(worker.nodes, std::memory_order_relaxed);
+        worker.nodes = 0;
+        if(isCancelled())
+        {
+            stop = true;
+        }
+    }
+
+    for(int k = 0; k < count; ++k)
+    {
+        worker.moves[depth] = childMoves[k];
+        if(search(worker, children[k], depth + 1, togo - 1))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OptimalSolver::isCancelled() const
+{
+    return cancelled != nullptr && cancelled->load(std::memory_order_relaxed);
+}
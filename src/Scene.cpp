@@ -17,18 +17,42 @@
   along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtx/rotate_vector.hpp>
+#include "../include/Importer.hpp"
 #include "../include/Scene.hpp"
 
-Scene::Scene(int width, int height) :
+namespace {
+
+const char* const FRAME_BLOCK_PATH = "resources/shaders/frame.glsl";
+
+std::string readShaderSource(const char* file)
+{
+    std::ifstream sourceFile(file);
+    if(!sourceFile)
+    {
+        std::cout << "Unable to open shader source file: " << file << '\n';
+        exit(1);
+    }
+    return std::string((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+Scene::Scene(int width, int height, int cubeSize) :
 camera{width, height},
 cameraSpeed{0.1},
-depthBiasMVP(glm::mat4(1.0f)),
+cubeSize{cubeSize},
+transformUpdates{0},
+lastTransformUpdates{0},
+frameTransformUpdates{0},
+shadowPlacements{0},
+shadowMapValid{false},
 ambientLightValue{0.5f}
 {
     light.position = glm::vec3(-10.0f, 10.0f, 10.0f);
@@ -39,6 +63,13 @@ ambientLightValue{0.5f}
                                                light.position.y - light.target.y,
                                                light.position.z - light.target.z));
 
+    // The light never moves, so its transforms are computed once
+    glm::mat4 depthProjectionMatrix = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 10.0f, 20.0f);
+    glm::mat4 depthViewMatrix = glm::lookAt(light.position, light.target, glm::vec3(0.0f, 1.0f, 0.0f));
+    shadowViewProjectionMatrix = depthProjectionMatrix * depthViewMatrix;
+    depthBiasMVP = biasMatrix * shadowViewProjectionMatrix;
+    transformUpdates += 4;
+
     glm::vec3 position = glm::vec3(-10.0f, 10.0f, 10.0f);
     glm::vec3 rgb = glm::vec3(1.0f);
     glm::vec3 target = glm::vec3(0.0f);
@@ -50,9 +81,12 @@ Scene::~Scene() {}
 
 void Scene::initModels()
 {
+    frameUniforms.init();
     currentShaderProgram = createShaderProgram("resources/shaders/shader.vert",
                                                "resources/shaders/shader.frag");
-    Cube c(currentShaderProgram);
+    cubieShaderProgram = createShaderProgram("resources/shaders/cubie.vert",
+                                             "resources/shaders/cubie.frag");
+    Cube c(cubieShaderProgram, cubeSize);
     cube = c;
 
     Importer importer("resources/models/plane.q3d");
@@ -60,17 +94,25 @@ void Scene::initModels()
     std::vector<glm::vec3> vs = objects[0].vs;
     std::vector<glm::vec3> ns = objects[0].ns;
     std::vector<glm::vec2> uv = objects[0].uvs;
-    std::string texture       = objects[0].texturePath;
-    GLuint vertexCount        = objects[0].vsSize;
+    std::vector<GLuint> is    = objects[0].indices;
 
-    Model model(vs, ns, uv, texture, vertexCount, currentShaderProgram, 0.0f, true);
+    // Every texture the scene uses is a layer of one array, bound once to the textureSampler unit
+    std::vector<std::string> texturePaths;
+    for(const Importer::Mesh& object : objects)
+    {
+        texturePaths.push_back(object.texturePath);
+    }
+    textures.load(texturePaths);
+    textures.bind(GL_TEXTURE1);
+
+    Model model(vs, ns, uv, is, textures.getLayer(objects[0].texturePath), currentShaderProgram, 0.0f, true);
     plane = model;
 }
 
 void Scene::initShadowMap(int windowWidth, int windowHeight)
 {
-    shaderProgramShadowMap = createShaderProgram("resources/shaders/shadow_map.vert",
-                                                 "resources/shaders/shadow_map.frag");
+    cubieShadowMapProgram = createShaderProgram("resources/shaders/cubie_shadow_map.vert",
+                                                "resources/shaders/shadow_map.frag");
     glGenFramebuffers(1, &FBOshadow);
     glBindFramebuffer(GL_FRAMEBUFFER, FBOshadow);
     glGenTextures(1, &shadowMap);
@@ -93,38 +135,40 @@ void Scene::initShadowMap(int windowWidth, int windowHeight)
         exit(1);
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0); // Bind windowing system's framebuffer
+    shadowMapValid = false;
 }
 
 void Scene::render()
 {
-    shadowPass();
+    updateFrameUniforms();
+    cube.operations();
+    // The light and the plane never move, so the shadow map stays valid until the cubies do
+    if(!shadowMapValid || cube.getPlacementCount() != shadowPlacements)
+    {
+        shadowPass();
+        shadowPlacements = cube.getPlacementCount();
+        shadowMapValid = true;
+    }
     //visualizeShadowMap(); // For testing purposes only
     renderPass();
+
+    unsigned long total = transformUpdates + camera.getTransformUpdates() + plane.getTransformUpdates() +
+                          cube.getTransformUpdates();
+    frameTransformUpdates = total - lastTransformUpdates;
+    lastTransformUpdates = total;
 }
 
 void Scene::shadowPass()
 {
-    glm::mat4 depthProjectionMatrix = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 10.0f, 20.0f);
-    glm::mat4 depthViewMatrix = glm::lookAt(light.position, light.target, glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 shadowViewProjection = depthProjectionMatrix * depthViewMatrix;
-    depthBiasMVP = biasMatrix * depthProjectionMatrix * depthViewMatrix;
-
-    glUseProgram(shaderProgramShadowMap);
     glBindFramebuffer(GL_FRAMEBUFFER, FBOshadow);
     glClear(GL_DEPTH_BUFFER_BIT);
     glPolygonOffset(4.0f, 4.0f);
     glEnable(GL_POLYGON_OFFSET_FILL); // Avoid depth fighting issues
 
-    GLint mvp = glGetUniformLocation(shaderProgramShadowMap, "shadowViewProjectionMatrix");
-    glUniformMatrix4fv(mvp, 1, GL_FALSE, &shadowViewProjection[0][0]);
-
-    glEnableVertexAttribArray(0);
-
-    cube.operations();
-    cube.renderShadowMap(shaderProgramShadowMap);
-    plane.renderShadowMap(shaderProgramShadowMap);
-
-    glDisableVertexAttribArray(0);
+    // The plane lies under the cube and shadows nothing, so the cubies are the only casters: the
+    // whole pass is one instanced draw. Where the map is left clear the plane is lit, as before.
+    glUseProgram(cubieShadowMapProgram);
+    cube.renderShadowMap();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0); // Bind windowing system's framebuffer
     glDisable(GL_POLYGON_OFFSET_FILL);
@@ -132,28 +176,16 @@ void Scene::shadowPass()
 
 void Scene::renderPass()
 {
-    glUseProgram(currentShaderProgram);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    updateLightsAndCamera();
-
-    glEnableVertexAttribArray(0); // Vertex position attribute
-    glEnableVertexAttribArray(1); // Vertex normal attribute
-    glEnableVertexAttribArray(2); // Vertex UV coordinate attribute
-
-    GLint shadowMatrixLocation = glGetUniformLocation(currentShaderProgram, "depthBiasMVP");
-    glUniformMatrix4fv(shadowMatrixLocation, 1, GL_FALSE, &depthBiasMVP[0][0]);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, shadowMap);
-    GLint shadowMapID = glGetUniformLocation(currentShaderProgram, "shadowMap");
-    glUniform1i(shadowMapID, 0);
 
-    cube.render(getProjectionViewMatrix(), depthBiasMVP);
-    plane.render(getProjectionViewMatrix(), depthBiasMVP);
+    glUseProgram(currentShaderProgram);
+    plane.render(getProjectionViewMatrix());
 
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    glDisableVertexAttribArray(2);
+    glUseProgram(cubieShaderProgram);
+    cube.render();
 }
 
 Cube& Scene::getCube()
@@ -171,6 +203,11 @@ GLfloat Scene::getCameraSpeed()
     return cameraSpeed;
 }
 
+unsigned long Scene::getFrameTransformUpdates()
+{
+    return frameTransformUpdates;
+}
+
 glm::vec3 Scene::getCameraPosition()
 {
     return camera.getPosition();
@@ -186,47 +223,39 @@ void Scene::handleCamera()
     camera.move();
 }
 
-void Scene::updateLightsAndCamera()
+void Scene::updateFrameUniforms()
 {
-    // TODO: Only update if changed.
-
-    GLint lightLocation = glGetUniformLocation(currentShaderProgram, "light.position");
-    glUniform3fv(lightLocation, 1, &light.position[0]);
-
-    GLint lightRGB = glGetUniformLocation(currentShaderProgram, "light.rgb");
-    glUniform3fv(lightRGB, 1, &light.rgb[0]);
-
-    GLint attenuation = glGetUniformLocation(currentShaderProgram, "light.attenuation");
-    glUniform1f(attenuation, light.attenuation);
-
-    GLint direction = glGetUniformLocation(currentShaderProgram, "light.direction");
-    glUniform3fv(direction, 1, &light.direction[0]);
-
-    GLint isPoint = glGetUniformLocation(currentShaderProgram, "light.isPoint");
-    glUniform1i(isPoint, GL_FALSE);
-
-    GLint ambientLight = glGetUniformLocation(currentShaderProgram, "ambientLight");
-    glUniform1f(ambientLight, ambientLightValue);
-
-    GLint cameraPosition = glGetUniformLocation(currentShaderProgram, "cameraPosition");
-    glUniform3fv(cameraPosition, 1, &getCameraPosition()[0]);
+    FrameUniforms::Block frame = {};
+    frame.viewProjectionMatrix = getProjectionViewMatrix();
+    frame.shadowViewProjectionMatrix = shadowViewProjectionMatrix;
+    frame.depthBiasMVP = depthBiasMVP;
+    frame.lightPosition = light.position;
+    frame.lightRGB = light.rgb;
+    frame.lightAttenuation = light.attenuation;
+    frame.lightDirection = light.direction;
+    frame.lightIsPoint = GL_FALSE;
+    frame.ambientLight = ambientLightValue;
+    frame.cameraPosition = getCameraPosition();
+    frameUniforms.update(frame);
 }
 
 void Scene::addShader(GLuint shaderProgram, const char* file, GLenum shaderType)
 {
-    std::string shaderString;
-    const GLchar* shaderSrc;
-    std::ifstream sourceFile(file);
-    if(sourceFile)
+    // Only comments may come before the #version line, so the Frame block goes after it; #line
+    // keeps compile errors at the file's own line numbers
+    std::string source = readShaderSource(file);
+    size_t version = source.compare(0, 8, "#version") == 0 ? 0 : source.find("\n#version");
+    if(version == std::string::npos)
     {
-        shaderString.assign((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
-        shaderSrc = shaderString.c_str();
-    }
-    else
-    {
-        std::cout << "Unable to open shader source file: " << file << '\n';
+        std::cout << "Shader source file has no #version line: " << file << '\n';
         exit(1);
     }
+    size_t versionEnd = source.find('\n', version + 1);
+    versionEnd = versionEnd == std::string::npos ? source.size() : versionEnd + 1;
+    int nextLine = std::count(source.begin(), source.begin() + versionEnd, '\n') + 1;
+    std::string shaderString = source.substr(0, versionEnd) + readShaderSource(FRAME_BLOCK_PATH) +
+                               "\n#line " + std::to_string(nextLine) + "\n" + source.substr(versionEnd);
+    const GLchar* shaderSrc = shaderString.c_str();
 
     GLuint shaderObj = glCreateShader(shaderType);
     if(shaderObj == 0)
@@ -270,6 +299,13 @@ GLuint Scene::createShaderProgram(const char* vertShaderPath, const char* fragSh
         std::cout << "Error linking shader program: " << errorLog << '\n';
         exit(1);
     }
+
+    // Set once per program: they never change, and uniforms keep their values between frames
+    frameUniforms.bindProgram(shaderProgram);
+    glUseProgram(shaderProgram);
+    glUniform1i(glGetUniformLocation(shaderProgram, "shadowMap"), 0);
+    glUniform1i(glGetUniformLocation(shaderProgram, "textureSampler"), 1);
+
     glValidateProgram(shaderProgram);
     glGetProgramiv(shaderProgram, GL_VALIDATE_STATUS, &success);
     if(!success)
@@ -296,6 +332,11 @@ void Scene::visualizeShadowMap()
     glGenBuffers(1, &VBOquad);
     glBindBuffer(GL_ARRAY_BUFFER, VBOquad);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadData), quadData, GL_STATIC_DRAW);
+    GLuint VAOquad;
+    glGenVertexArrays(1, &VAOquad);
+    glBindVertexArray(VAOquad);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
 
     GLuint quadProgram = createShaderProgram("resources/shaders/shadtest.vert",
                                              "resources/shaders/shadtest.frag");
@@ -305,9 +346,5 @@ void Scene::visualizeShadowMap()
     glActiveTexture(GL_TEXTURE2);
     glBindTexture(GL_TEXTURE_2D, shadowMap);
     glUniform1i(texID, 2);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOquad);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glDisableVertexAttribArray(0);
 }
@@ -0,0 +1,128 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include "../include/Scrambler.hpp"
+#include "../include/Coordinates.hpp"
+
+namespace {
+
+const int N_CORNER_PERMUTATIONS = 40320;   // 8!
+const int N_EDGE_PERMUTATIONS = 479001600; // 12!
+
+/**
+ * Set the positions of a state to the permutation with a rank, read as Lehmer code digits: each
+ * digit picks one of the cubies not yet placed, which are kept in order as 4-bit values in a
+ * list, so a pick is a shift and a mask. Returns the parity, the sum of the digits modulo 2, as
+ * each digit counts the inversions of one cubie.
+ *
+ * @param rank The rank, in 0 to n! - 1
+ * @param n The number of cubies
+ * @param place Called with each position and cubie
+ */
+template<typename Place>
+int unrank(uint32_t rank, int n, Place place)
+{
+    uint64_t remaining = 0xBA9876543210ULL;
+    int parity = 0;
+    for(int i = 0; i < n; ++i)
+    {
+        uint32_t radix = n - i;
+        int digit = rank % radix;
+        rank /= radix;
+        int shift = 4 * digit;
+        uint64_t below = (1ULL << shift) - 1;
+        place(i, (int)(remaining >> shift) & 0xF);
+        remaining = (remaining & below) | ((remaining >> 4) & ~below);
+        parity ^= digit;
+    }
+    return parity & 1;
+}
+
+} // namespace
+
+Scrambler::Scrambler(uint64_t seed, uint64_t stream) :
+cornerPermutations{0, N_CORNER_PERMUTATIONS - 1},
+edgePermutations{0, N_EDGE_PERMUTATIONS - 1},
+twists{0, Coordinates::N_TWIST - 1},
+flips{0, Coordinates::N_FLIP - 1}
+{
+    std::seed_seq sequence{(uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)stream, (uint32_t)(stream >> 32)};
+    random.seed(sequence);
+}
+
+Scrambler::~Scrambler() {}
+
+CubeState Scrambler::next()
+{
+    uint32_t cornerRank = cornerPermutations(random);
+    uint32_t edgeRank = edgePermutations(random);
+    int twist = twists(random);
+    int flip = flips(random);
+
+    // Orientations are the digits of the twist in base 3 and the flip in base 2, with the last
+    // one fixed by the others.
+    CubeState state;
+    int twistSum = 0;
+    int cornerParity = unrank(cornerRank, CubeState::N_CORNERS, [&](int position, int cubie)
+    {
+        int orientation = (3 - twistSum % 3) % 3;
+        if(position < CubeState::N_CORNERS - 1)
+        {
+            orientation = twist % 3;
+            twist /= 3;
+            twistSum += orientation;
+        }
+        state.setCorner(position, cubie, orientation);
+    });
+    int edges[CubeState::N_EDGES];
+    int edgeParity = unrank(edgeRank, CubeState::N_EDGES, [&](int position, int cubie)
+    {
+        edges[position] = cubie;
+    });
+    if(cornerParity != edgeParity)
+    {
+        std::swap(edges[CubeState::N_EDGES - 2], edges[CubeState::N_EDGES - 1]);
+    }
+    int flipSum = 0;
+    for(int i = 0; i < CubeState::N_EDGES - 1; ++i)
+    {
+        int orientation = (flip >> i) & 1;
+        flipSum ^= orientation;
+        state.setEdge(i, edges[i], orientation);
+    }
+    state.setEdge(CubeState::N_EDGES - 1, edges[CubeState::N_EDGES - 1], flipSum);
+    return state;
+}
+
+CubeState Scrambler::next(std::vector<int>& scramble)
+{
+    if(!solver)
+    {
+        solver.reset(new TwoPhaseSolver());
+    }
+    CubeState state = next();
+    solver->solve(state, scramble);
+    std::reverse(scramble.begin(), scramble.end());
+    for(int& move : scramble)
+    {
+        move = CubeState::inverseMove(move);
+    }
+    return state;
+}
@@ -0,0 +1,314 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include "../include/SimdCubeState.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SHUFFLE 1
+#endif
+
+namespace {
+
+const int CORNER_LANE = 16; // Offset of the corners
+
+/**
+ * Per-move shuffle. Byte i of the result is byte permutation[i] of the same half plus
+ * orientation[i], less modulus[i] if that reaches it.
+ */
+struct ShuffleMove
+{
+    alignas(32) uint8_t permutation[32];
+    alignas(32) uint8_t orientation[32];
+};
+
+struct ShuffleTables
+{
+    ShuffleMove moves[CubeState::N_MOVES];
+    alignas(32) uint8_t modulus[32];
+
+    ShuffleTables()
+    {
+        for(int i = 0; i < 32; ++i)
+        {
+            modulus[i] = i < CORNER_LANE ? 32 : 48;
+        }
+
+        for(int m = 0; m < CubeState::N_MOVES; ++m)
+        {
+            // The move applied to the solved state is its own permutation and orientation
+            CubeState state;
+            state.apply(m);
+            ShuffleMove& move = moves[m];
+            for(int i = 0; i < 16; ++i)
+            {
+                // Unused bytes map to themselves and stay 0
+                move.permutation[i] = (uint8_t)i;
+                move.permutation[CORNER_LANE + i] = (uint8_t)i;
+                move.orientation[i] = 0;
+                move.orientation[CORNER_LANE + i] = 0;
+            }
+            for(int i = 0; i < CubeState::N_EDGES; ++i)
+            {
+                move.permutation[i] = (uint8_t)state.edgePermutation(i);
+                move.orientation[i] = (uint8_t)(state.edgeOrientation(i) << 4);
+            }
+            for(int i = 0; i < CubeState::N_CORNERS; ++i)
+            {
+                move.permutation[CORNER_LANE + i] = (uint8_t)state.cornerPermutation(i);
+                move.orientation[CORNER_LANE + i] = (uint8_t)(state.cornerOrientation(i) << 4);
+            }
+        }
+    }
+};
+
+const ShuffleTables& shuffleTables()
+{
+    static const ShuffleTables tables;
+    return tables;
+}
+
+void applyScalar(uint8_t* bytes, const int* moves, int count)
+{
+    const ShuffleTables& t = shuffleTables();
+    uint8_t next[32];
+    for(int k = 0; k < count; ++k)
+    {
+        const ShuffleMove& m = t.moves[moves[k]];
+        for(int i = 0; i < CubeState::N_EDGES; ++i)
+        {
+            next[i] = (uint8_t)(bytes[m.permutation[i]] ^ m.orientation[i]);
+        }
+        for(int i = CORNER_LANE; i < CORNER_LANE + CubeState::N_CORNERS; ++i)
+        {
+            int value = bytes[CORNER_LANE + m.permutation[i]] + m.orientation[i];
+            next[i] = (uint8_t)(value >= 48 ? value - 48 : value);
+        }
+        memcpy(bytes, next, CubeState::N_EDGES);
+        memcpy(bytes + CORNER_LANE, next + CORNER_LANE, CubeState::N_CORNERS);
+    }
+}
+
+#ifdef HAVE_X86_SHUFFLE
+
+__attribute__((target("ssse3")))
+void applySsse3(uint8_t* bytes, const int* moves, int count)
+{
+    const ShuffleTables& t = shuffleTables();
+    __m128i edges = _mm_load_si128((const __m128i*)bytes);
+    __m128i corners = _mm_load_si128((const __m128i*)(bytes + CORNER_LANE));
+    const __m128i edgeModulus = _mm_load_si128((const __m128i*)t.modulus);
+    const __m128i cornerModulus = _mm_load_si128((const __m128i*)(t.modulus + CORNER_LANE));
+    for(int k = 0; k < count; ++k)
+    {
+        const ShuffleMove& m = t.moves[moves[k]];
+        edges = _mm_shuffle_epi8(edges, _mm_load_si128((const __m128i*)m.permutation));
+        edges = _mm_add_epi8(edges, _mm_load_si128((const __m128i*)m.orientation));
+        edges = _mm_min_epu8(edges, _mm_sub_epi8(edges, edgeModulus));
+        corners = _mm_shuffle_epi8(corners, _mm_load_si128((const __m128i*)(m.permutation + CORNER_LANE)));
+        corners = _mm_add_epi8(corners, _mm_load_si128((const __m128i*)(m.orientation + CORNER_LANE)));
+        corners = _mm_min_epu8(corners, _mm_sub_epi8(corners, cornerModulus));
+    }
+    _mm_store_si128((__m128i*)bytes, edges);
+    _mm_store_si128((__m128i*)(bytes + CORNER_LANE), corners);
+}
+
+__attribute__((target("avx2")))
+void applyAvx2(uint8_t* bytes, const int* moves, int count)
+{
+    // vpshufb shuffles within each 16-byte lane, so one shuffle turns edges and corners
+    const ShuffleTables& t = shuffleTables();
+    __m256i state = _mm256_load_si256((const __m256i*)bytes);
+    const __m256i modulus = _mm256_load_si256((const __m256i*)t.modulus);
+    for(int k = 0; k < count; ++k)
+    {
+        const ShuffleMove& m = t.moves[moves[k]];
+        state = _mm256_shuffle_epi8(state, _mm256_load_si256((const __m256i*)m.permutation));
+        state = _mm256_add_epi8(state, _mm256_load_si256((const __m256i*)m.orientation));
+        state = _mm256_min_epu8(state, _mm256_sub_epi8(state, modulus));
+    }
+    _mm256_store_si256((__m256i*)bytes, state);
+}
+
+#endif // HAVE_X86_SHUFFLE
+
+SimdCubeState::Level detectLevel()
+{
+#ifdef HAVE_X86_SHUFFLE
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return SimdCubeState::AVX2;
+    }
+    if(__builtin_cpu_supports("ssse3"))
+    {
+        return SimdCubeState::SSSE3;
+    }
+#endif
+    return SimdCubeState::SCALAR;
+}
+
+const SimdCubeState::Level supportedLevel = detectLevel();
+SimdCubeState::Level activeLevel = supportedLevel;
+
+} // namespace
+
+SimdCubeState::SimdCubeState()
+{
+    memset(bytes, 0, sizeof(bytes));
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        bytes[i] = (uint8_t)i;
+    }
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        bytes[CORNER_LANE + i] = (uint8_t)i;
+    }
+}
+
+SimdCubeState::SimdCubeState(const CubeState& state)
+{
+    memset(bytes, 0, sizeof(bytes));
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        bytes[i] = (uint8_t)(state.edgePermutation(i) | state.edgeOrientation(i) << 4);
+    }
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        bytes[CORNER_LANE + i] = (uint8_t)(state.cornerPermutation(i) | state.cornerOrientation(i) << 4);
+    }
+}
+
+CubeState SimdCubeState::toCubeState() const
+{
+    CubeState state;
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        state.setEdge(i, edgePermutation(i), edgeOrientation(i));
+    }
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        state.setCorner(i, cornerPermutation(i), cornerOrientation(i));
+    }
+    return state;
+}
+
+void SimdCubeState::apply(int move)
+{
+    apply(&move, 1);
+}
+
+void SimdCubeState::apply(const std::vector<int>& moves)
+{
+    apply(moves.data(), (int)moves.size());
+}
+
+void SimdCubeState::apply(const int* moves, int count)
+{
+    switch(activeLevel)
+    {
+#ifdef HAVE_X86_SHUFFLE
+        case AVX2:
+            applyAvx2(bytes, moves, count);
+            break;
+        case SSSE3:
+            applySsse3(bytes, moves, count);
+            break;
+#endif
+        default:
+            applyScalar(bytes, moves, count);
+            break;
+    }
+}
+
+int SimdCubeState::cornerPermutation(int position) const
+{
+    return bytes[CORNER_LANE + position] & 15;
+}
+
+int SimdCubeState::cornerOrientation(int position) const
+{
+    return bytes[CORNER_LANE + position] >> 4;
+}
+
+int SimdCubeState::edgePermutation(int position) const
+{
+    return bytes[position] & 15;
+}
+
+int SimdCubeState::edgeOrientation(int position) const
+{
+    return bytes[position] >> 4;
+}
+
+bool SimdCubeState::isSolved() const
+{
+    return *this == SimdCubeState();
+}
+
+int SimdCubeState::cubieAt(int slot) const
+{
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        if(CubeState::cornerSlot(i) == slot)
+        {
+            return CubeState::cornerSlot(cornerPermutation(i));
+        }
+    }
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        if(CubeState::edgeSlot(i) == slot)
+        {
+            return CubeState::edgeSlot(edgePermutation(i));
+        }
+    }
+    return slot; // Centres
+}
+
+bool SimdCubeState::operator==(const SimdCubeState& other) const
+{
+    return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+bool SimdCubeState::operator!=(const SimdCubeState& other) const
+{
+    return !(*this == other);
+}
+
+SimdCubeState::Level SimdCubeState::getLevel()
+{
+    return activeLevel;
+}
+
+SimdCubeState::Level SimdCubeState::getSupportedLevel()
+{
+    return supportedLevel;
+}
+
+void SimdCubeState::setLevel(Level level)
+{
+    activeLevel = level < supportedLevel ? level : supportedLevel;
+}
+
+const char* SimdCubeState::levelName(Level level)
+{
+    static const char* names[] = {"scalar", "SSSE3", "AVX2"};
+    return names[level];
+}
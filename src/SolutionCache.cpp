@@ -0,0 +1,232 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include "../include/SolutionCache.hpp"
+#include "../include/Symmetry.hpp"
+#include "../include/TableFile.hpp"
+
+SolutionCache::SolutionCache(size_t capacity, int shardCount) :
+capacity{capacity},
+hits{0},
+misses{0},
+evictions{0}
+{
+    // No more shards than solutions, so no shard rounds its share up past the capacity
+    shardCount = std::max(1, shardCount);
+    if((size_t)shardCount > capacity)
+    {
+        shardCount = (int)std::max<size_t>(1, capacity);
+    }
+    shardCapacity = std::max<size_t>(1, capacity / shardCount);
+    for(int i = 0; i < shardCount; ++i)
+    {
+        shards.emplace_back(new Shard());
+        shards.back()->hand = 0;
+    }
+}
+
+SolutionCache::~SolutionCache() {}
+
+bool SolutionCache::lookup(Solver solver, const CubeState& state, int maxLength, std::vector<int>& solution)
+{
+    CubeState canonical;
+    int symmetry = Symmetry::representative(state, canonical);
+    Key key = makeKey(solver, canonical);
+    Shard& shard = shardOf(key);
+
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if(found == shard.index.end() || shard.entries[found->second].length > maxLength)
+        {
+            ++misses;
+            return false;
+        }
+        shard.referenced[found->second] = 1;
+        entry = shard.entries[found->second];
+    }
+
+    // The entry solves S * state * S^-1, so its moves conjugated by S^-1 solve the state
+    int inverse = Symmetry::inverse(symmetry);
+    solution.clear();
+    for(int i = 0; i < entry.length; ++i)
+    {
+        solution.push_back(Symmetry::conjugateMove(entry.moves[i], inverse));
+    }
+    ++hits;
+    return true;
+}
+
+void SolutionCache::insert(Solver solver, const CubeState& state, const std::vector<int>& solution)
+{
+    if(solution.size() > (size_t)MAX_LENGTH)
+    {
+        return;
+    }
+
+    Entry entry;
+    int symmetry = Symmetry::representative(state, entry.state);
+    entry.solver = (uint8_t)solver;
+    entry.length = (uint8_t)solution.size();
+    for(size_t i = 0; i < solution.size(); ++i)
+    {
+        entry.moves[i] = (int8_t)Symmetry::conjugateMove(solution[i], symmetry);
+    }
+    insertEntry(entry);
+}
+
+uint64_t SolutionCache::getHits() const
+{
+    return hits;
+}
+
+uint64_t SolutionCache::getMisses() const
+{
+    return misses;
+}
+
+uint64_t SolutionCache::getEvictions() const
+{
+    return evictions;
+}
+
+size_t SolutionCache::getSize()
+{
+    size_t size = 0;
+    for(std::unique_ptr<Shard>& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size += shard->entries.size();
+    }
+    return size;
+}
+
+size_t SolutionCache::getCapacity() const
+{
+    return capacity;
+}
+
+bool SolutionCache::load(const std::string& path)
+{
+    TableFile file;
+    if(!file.open(path))
+    {
+        return false;
+    }
+    const uint64_t* count = (const uint64_t*)file.getTable("count", sizeof(uint64_t));
+    if(count == nullptr)
+    {
+        return false;
+    }
+    if(*count == 0)
+    {
+        return true;
+    }
+    const Entry* entries = (const Entry*)file.getTable("solutions", *count * sizeof(Entry));
+    if(entries == nullptr)
+    {
+        return false;
+    }
+
+    for(uint64_t i = 0; i < *count; ++i)
+    {
+        // The file is not verified before use, so check each solution
+        CubeState state = entries[i].state;
+        bool valid = state.isSolvable() && entries[i].length <= MAX_LENGTH && entries[i].solver <= OPTIMAL;
+        for(int k = 0; valid && k < entries[i].length; ++k)
+        {
+            valid = entries[i].moves[k] >= 0 && entries[i].moves[k] < CubeState::N_MOVES;
+            if(valid)
+            {
+                state.apply(entries[i].moves[k]);
+            }
+        }
+        if(valid && state.isSolved())
+        {
+            insertEntry(entries[i]);
+        }
+    }
+    return true;
+}
+
+bool SolutionCache::save(const std::string& path)
+{
+    std::vector<Entry> entries;
+    for(std::unique_ptr<Shard>& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        entries.insert(entries.end(), shard->entries.begin(), shard->entries.end());
+    }
+    uint64_t count = entries.size();
+    return TableFile::write(path, {{"count", &count, sizeof(count)},
+                                   {"solutions", entries.data(), count * sizeof(Entry)}});
+}
+
+size_t SolutionCache::KeyHash::operator()(const Key& key) const
+{
+    uint64_t hash = key.first * 0x9E3779B185EBCA87ULL ^ key.second * 0xC2B2AE3D27D4EB4FULL;
+    return (size_t)(hash ^ (hash >> 29));
+}
+
+SolutionCache::Key SolutionCache::makeKey(int solver, const CubeState& state)
+{
+    // The edge word uses 60 bits, leaving the top one for the solver
+    return Key(state.getCornerWord(), state.getEdgeWord() | (uint64_t)solver << 63);
+}
+
+SolutionCache::Shard& SolutionCache::shardOf(const Key& key)
+{
+    // The low bits pick the bucket within the shard's map, so pick the shard with the high ones
+    return *shards[(KeyHash()(key) >> 32) % shards.size()];
+}
+
+void SolutionCache::insertEntry(const Entry& entry)
+{
+    Key key = makeKey(entry.solver, entry.state);
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.index.find(key);
+    if(found != shard.index.end())
+    {
+        shard.entries[found->second] = entry;
+        return;
+    }
+    if(shard.entries.size() < shardCapacity)
+    {
+        shard.index[key] = (uint32_t)shard.entries.size();
+        shard.entries.push_back(entry);
+        shard.referenced.push_back(0);
+        return;
+    }
+
+    while(shard.referenced[shard.hand])
+    {
+        shard.referenced[shard.hand] = 0;
+        shard.hand = (shard.hand + 1) % shard.entries.size();
+    }
+    Entry& victim = shard.entries[shard.hand];
+    shard.index.erase(makeKey(victim.solver, victim.state));
+    victim = entry;
+    shard.index[key] = (uint32_t)shard.hand;
+    shard.hand = (shard.hand + 1) % shard.entries.size();
+    ++evictions;
+}
@@ -0,0 +1,144 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Headless batch solver, built as bin/cub3r-solve. Links no SDL or GL.
+ *
+ * Usage: cub3r-solve [options] [file]
+ *
+ * Reads one scramble or facelet string per line from the file, or standard input if none is
+ * given, and writes one solution per line to standard output in the same order. A summary goes
+ * to standard error.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "../include/BatchSolver.hpp"
+
+namespace {
+
+void usage()
+{
+    std::cerr << "Usage: cub3r-solve [options] [file]\n\n"
+              << "  --optimal          Find shortest solutions (slow) instead of two-phase solutions\n"
+              << "  --threads N        Solver threads, default one per hardware thread\n"
+              << "  --max-length N     Longest solution allowed, default 20\n"
+              << "  --window N         Lines in flight at once, default 1024\n"
+              << "  --cache N          Solutions to cache, so repeated and symmetric positions are\n"
+              << "                     not searched again, default 65536, 0 for none\n"
+              << "  --cache-file FILE  Load the cache from FILE at startup and save it on exit\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BatchSolver::Method method = BatchSolver::TWO_PHASE;
+    int threads = 0;
+    int maxLength = 20;
+    int window = 1024;
+    int cacheSize = 65536;
+    const char* cachePath = nullptr;
+    const char* path = nullptr;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(strcmp(argv[i], "--optimal") == 0)
+        {
+            method = BatchSolver::OPTIMAL;
+        }
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--max-length") == 0 && i + 1 < argc)
+        {
+            maxLength = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+        {
+            window = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+        {
+            cacheSize = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--cache-file") == 0 && i + 1 < argc)
+        {
+            cachePath = argv[++i];
+        }
+        else if(argv[i][0] != '-' && path == nullptr)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    std::ifstream file;
+    if(path != nullptr)
+    {
+        file.open(path);
+        if(!file)
+        {
+            std::cerr << "Error: could not open " << path << '\n';
+            return 1;
+        }
+    }
+
+    double loadSeconds = method == BatchSolver::TWO_PHASE ? TwoPhaseSolver::initTables()
+                                                          : OptimalSolver::initTables();
+    std::ios::sync_with_stdio(false);
+
+    std::unique_ptr<SolutionCache> cache;
+    if(cacheSize > 0)
+    {
+        cache.reset(new SolutionCache(cacheSize));
+        if(cachePath != nullptr)
+        {
+            cache->load(cachePath);
+        }
+    }
+
+    BatchSolver solver(method, threads, window, maxLength, cache.get());
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t solved = solver.run(path != nullptr ? file : std::cin, std::cout);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cerr << "Solved " << solved << " of " << solver.getLineCount() << " lines in " << seconds
+              << " s on " << solver.getThreadCount() << " threads (" << (seconds > 0.0 ? solved / seconds : 0.0)
+              << " solves/s, tables loaded in " << loadSeconds << " s)\n";
+    if(cache)
+    {
+        std::cerr << "Cache: " << cache->getHits() << " hits, " << cache->getMisses() << " misses, "
+                  << cache->getEvictions() << " evictions, " << cache->getSize() << " solutions held\n";
+        if(cachePath != nullptr)
+        {
+            cache->save(cachePath);
+        }
+    }
+    return solved == solver.getLineCount() ? 0 : 2;
+}
@@ -0,0 +1,177 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include "../include/SolverWorker.hpp"
+
+std::vector<int> SolverWorker::Message::getSolution() const
+{
+    return std::vector<int>(moves, moves + (type == SOLVED ? depth : 0));
+}
+
+SolverWorker::SolverWorker(SolutionCache::Solver solver) :
+solverType{solver},
+pendingRequest{0},
+quit{false},
+requests{0},
+current{0},
+cancelled{false},
+busy{false},
+thread{&SolverWorker::work, this}
+{}
+
+SolverWorker::~SolverWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        current = 0;
+        cancelled = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+unsigned int SolverWorker::solve(const CubeState& state)
+{
+    unsigned int request;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request = ++requests;
+        pendingState = state;
+        pendingRequest = request;
+        current = request;
+        cancelled = true;
+        busy = true;
+    }
+    wake.notify_one();
+    return request;
+}
+
+void SolverWorker::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingRequest = 0;
+    current = 0;
+    cancelled = true;
+}
+
+bool SolverWorker::poll(Message& message)
+{
+    return mailbox.poll(message);
+}
+
+bool SolverWorker::isBusy() const
+{
+    return busy;
+}
+
+void SolverWorker::work()
+{
+    while(true)
+    {
+        CubeState state;
+        unsigned int request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return quit || pendingRequest != 0; });
+            if(quit)
+            {
+                return;
+            }
+            state = pendingState;
+            request = pendingRequest;
+            pendingRequest = 0;
+            // Under the lock, so a cancel() can not be lost between taking and solving
+            cancelled = false;
+        }
+        run(state, request);
+        std::lock_guard<std::mutex> lock(mutex);
+        if(pendingRequest == 0)
+        {
+            busy = false;
+        }
+    }
+}
+
+void SolverWorker::run(const CubeState& state, unsigned int request)
+{
+    auto begin = std::chrono::steady_clock::now();
+    auto seconds = [begin]
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    };
+    Message message = {};
+    message.request = request;
+    auto progress = [&](int depth, uint64_t nodes)
+    {
+        message.type = Message::PROGRESS;
+        message.depth = depth;
+        message.nodes = nodes;
+        message.seconds = seconds();
+        deliver(message);
+    };
+
+    std::vector<int> solution;
+    bool solved;
+    if(solverType == SolutionCache::OPTIMAL)
+    {
+        if(!optimal)
+        {
+            // Leave a core for the thread that polls
+            int threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+            optimal.reset(new OptimalSolver(threads));
+            optimal->setCancelFlag(&cancelled);
+        }
+        optimal->setProgress(progress);
+        solved = optimal->solve(state, solution);
+        message.nodes = optimal->getNodeCount();
+    }
+    else
+    {
+        if(!twoPhase)
+        {
+            twoPhase.reset(new TwoPhaseSolver());
+            twoPhase->setCancelFlag(&cancelled);
+        }
+        twoPhase->setProgress(progress);
+        solved = twoPhase->solve(state, solution);
+        message.nodes = twoPhase->getNodeCount();
+    }
+
+    message.type = solved ? Message::SOLVED : Message::FAILED;
+    message.depth = solved ? (int)solution.size() : 0;
+    message.seconds = seconds();
+    std::copy(solution.begin(), solution.end(), message.moves);
+    deliver(message);
+}
+
+void SolverWorker::deliver(const Message& message)
+{
+    while(current == message.request && !mailbox.post(message))
+    {
+        if(message.type == Message::PROGRESS)
+        {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
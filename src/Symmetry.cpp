@@ -0,0 +1,356 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../include/Symmetry.hpp"
+
+namespace {
+
+/**
+ * Cubie-level state that can also hold reflections. A reflected corner has orientation 3-5,
+ * which CubeState has no room for.
+ */
+struct SymmetryCube
+{
+    int cp[CubeState::N_CORNERS];
+    int co[CubeState::N_CORNERS];
+    int ep[CubeState::N_EDGES];
+    int eo[CubeState::N_EDGES];
+
+    SymmetryCube()
+    {
+        for(int i = 0; i < CubeState::N_CORNERS; ++i)
+        {
+            cp[i] = i;
+            co[i] = 0;
+        }
+        for(int i = 0; i < CubeState::N_EDGES; ++i)
+        {
+            ep[i] = i;
+            eo[i] = 0;
+        }
+    }
+
+    explicit SymmetryCube(const CubeState& state)
+    {
+        for(int i = 0; i < CubeState::N_CORNERS; ++i)
+        {
+            cp[i] = state.cornerPermutation(i);
+            co[i] = state.cornerOrientation(i);
+        }
+        for(int i = 0; i < CubeState::N_EDGES; ++i)
+        {
+            ep[i] = state.edgePermutation(i);
+            eo[i] = state.edgeOrientation(i);
+        }
+    }
+
+    CubeState toCubeState() const
+    {
+        CubeState state;
+        for(int i = 0; i < CubeState::N_CORNERS; ++i)
+        {
+            state.setCorner(i, cp[i], co[i]);
+        }
+        for(int i = 0; i < CubeState::N_EDGES; ++i)
+        {
+            state.setEdge(i, ep[i], eo[i]);
+        }
+        return state;
+    }
+
+    bool isIdentity() const
+    {
+        SymmetryCube identity;
+        for(int i = 0; i < CubeState::N_CORNERS; ++i)
+        {
+            if(cp[i] != identity.cp[i] || co[i] != identity.co[i])
+            {
+                return false;
+            }
+        }
+        for(int i = 0; i < CubeState::N_EDGES; ++i)
+        {
+            if(ep[i] != identity.ep[i] || eo[i] != identity.eo[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * Product a * b: a followed by b. Orientations 0-2 are twists and 3-5 reflected twists; a
+ * reflection reverses the direction of the twists applied after it.
+ */
+SymmetryCube multiply(const SymmetryCube& a, const SymmetryCube& b)
+{
+    SymmetryCube result;
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        result.cp[i] = a.cp[b.cp[i]];
+        int first = a.co[b.cp[i]];
+        int second = b.co[i];
+        int orientation;
+        if(first < 3 && second < 3)
+        {
+            orientation = (first + second) % 3;
+        }
+        else if(first < 3)
+        {
+            orientation = 3 + (first + second) % 3;
+        }
+        else if(second < 3)
+        {
+            orientation = 3 + (first - second + 3) % 3;
+        }
+        else
+        {
+            orientation = (first - second + 3) % 3;
+        }
+        result.co[i] = orientation;
+    }
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        result.ep[i] = a.ep[b.ep[i]];
+        result.eo[i] = (a.eo[b.ep[i]] + b.eo[i]) % 2;
+    }
+    return result;
+}
+
+SymmetryCube basicSymmetry(const int* cp, const int* co, const int* ep, const int* eo)
+{
+    SymmetryCube cube;
+    for(int i = 0; i < CubeState::N_CORNERS; ++i)
+    {
+        cube.cp[i] = cp[i];
+        cube.co[i] = co[i];
+    }
+    for(int i = 0; i < CubeState::N_EDGES; ++i)
+    {
+        cube.ep[i] = ep[i];
+        cube.eo[i] = eo[i];
+    }
+    return cube;
+}
+
+struct SymmetryTables
+{
+    SymmetryCube cubes[Symmetry::N_SYMMETRIES];
+    int inverse[Symmetry::N_SYMMETRIES];
+    int moveConjugate[CubeState::N_MOVES][Symmetry::N_SYMMETRIES];
+
+    SymmetryTables()
+    {
+        // 120 degree turn about the URF-DBL diagonal
+        const int urf3cp[] = {0, 4, 5, 1, 3, 7, 6, 2};
+        const int urf3co[] = {1, 2, 1, 2, 2, 1, 2, 1};
+        const int urf3ep[] = {1, 8, 5, 9, 3, 11, 7, 10, 0, 4, 6, 2};
+        const int urf3eo[] = {1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1};
+        // Half turn about the F-B axis
+        const int f2cp[] = {5, 4, 7, 6, 1, 0, 3, 2};
+        const int f2co[] = {0, 0, 0, 0, 0, 0, 0, 0};
+        const int f2ep[] = {6, 5, 4, 7, 2, 1, 0, 3, 9, 8, 11, 10};
+        const int f2eo[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        // Quarter turn about the U-D axis
+        const int u4cp[] = {3, 0, 1, 2, 7, 4, 5, 6};
+        const int u4co[] = {0, 0, 0, 0, 0, 0, 0, 0};
+        const int u4ep[] = {3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10};
+        const int u4eo[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1};
+        // Reflection through the R-L plane
+        const int lr2cp[] = {1, 0, 3, 2, 5, 4, 7, 6};
+        const int lr2co[] = {3, 3, 3, 3, 3, 3, 3, 3};
+        const int lr2ep[] = {2, 1, 0, 3, 6, 5, 4, 7, 9, 8, 11, 10};
+        const int lr2eo[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        SymmetryCube urf3 = basicSymmetry(urf3cp, urf3co, urf3ep, urf3eo);
+        SymmetryCube f2 = basicSymmetry(f2cp, f2co, f2ep, f2eo);
+        SymmetryCube u4 = basicSymmetry(u4cp, u4co, u4ep, u4eo);
+        SymmetryCube lr2 = basicSymmetry(lr2cp, lr2co, lr2ep, lr2eo);
+
+        SymmetryCube cube;
+        int s = 0;
+        for(int a = 0; a < 3; ++a)
+        {
+            for(int b = 0; b < 2; ++b)
+            {
+                for(int c = 0; c < 4; ++c)
+                {
+                    for(int d = 0; d < 2; ++d)
+                    {
+                        cubes[s++] = cube;
+                        cube = multiply(cube, lr2);
+                    }
+                    cube = multiply(cube, u4);
+                }
+                cube = multiply(cube, f2);
+            }
+            cube = multiply(cube, urf3);
+        }
+
+        for(int i = 0; i < Symmetry::N_SYMMETRIES; ++i)
+        {
+            for(int j = 0; j < Symmetry::N_SYMMETRIES; ++j)
+            {
+                if(multiply(cubes[i], cubes[j]).isIdentity())
+                {
+                    inverse[i] = j;
+                    break;
+                }
+            }
+        }
+
+        CubeState moves[CubeState::N_MOVES];
+        for(int m = 0; m < CubeState::N_MOVES; ++m)
+        {
+            moves[m].apply(m);
+        }
+        for(int m = 0; m < CubeState::N_MOVES; ++m)
+        {
+            for(int i = 0; i < Symmetry::N_SYMMETRIES; ++i)
+            {
+                CubeState conjugate = multiply(multiply(cubes[i], SymmetryCube(moves[m])), cubes[inverse[i]]).toCubeState();
+                for(int k = 0; k < CubeState::N_MOVES; ++k)
+                {
+                    if(moves[k] == conjugate)
+                    {
+                        moveConjugate[m][i] = k;
+                    }
+                }
+            }
+        }
+    }
+};
+
+const SymmetryTables& symmetryTables()
+{
+    static const SymmetryTables tables;
+    return tables;
+}
+
+} // namespace
+
+CubeState Symmetry::conjugate(const CubeState& state, int symmetry)
+{
+    const SymmetryTables& t = symmetryTables();
+    SymmetryCube cube = multiply(t.cubes[symmetry], SymmetryCube(state));
+    return multiply(cube, t.cubes[t.inverse[symmetry]]).toCubeState();
+}
+
+int Symmetry::conjugateMove(int move, int symmetry)
+{
+    return symmetryTables().moveConjugate[move][symmetry];
+}
+
+int Symmetry::inverse(int symmetry)
+{
+    return symmetryTables().inverse[symmetry];
+}
+
+int Symmetry::representative(const CubeState& state, CubeState& canonical)
+{
+    const SymmetryTables& t = symmetryTables();
+    SymmetryCube cube(state);
+    canonical = state;
+    int best = 0;
+    for(int s = 1; s < N_SYMMETRIES; ++s)
+    {
+        CubeState conjugate = multiply(multiply(t.cubes[s], cube), t.cubes[t.inverse[s]]).toCubeState();
+        if(conjugate.getCornerWord() < canonical.getCornerWord() ||
+           (conjugate.getCornerWord() == canonical.getCornerWord() && conjugate.getEdgeWord() < canonical.getEdgeWord()))
+        {
+            canonical = conjugate;
+            best = s;
+        }
+    }
+    return best;
+}
+
+uint64_t Symmetry::getSymmetries(const CubeState& state)
+{
+    uint64_t symmetries = 0;
+    for(int s = 0; s < N_SYMMETRIES; ++s)
+    {
+        if(conjugate(state, s) == state)
+        {
+            symmetries |= 1ULL << s;
+        }
+    }
+    return symmetries;
+}
+
+bool Symmetry::isDuplicateMove(int move, uint64_t symmetries)
+{
+    const SymmetryTables& t = symmetryTables();
+    for(int s = 1; s < N_SYMMETRIES; ++s)
+    {
+        if((symmetries >> s & 1) && t.moveConjugate[move][s] < move)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Symmetry::buildConjugationTable(std::vector<uint16_t>& table, int size, int (*get)(const CubeState&),
+                                     void (*set)(CubeState&, int))
+{
+    table.assign(size * N_UD_SYMMETRIES, 0);
+    for(int i = 0; i < size; ++i)
+    {
+        CubeState state;
+        set(state, i);
+        for(int s = 0; s < N_UD_SYMMETRIES; ++s)
+        {
+            table[i * N_UD_SYMMETRIES + s] = (uint16_t)get(conjugate(state, s));
+        }
+    }
+}
+
+int Symmetry::buildClasses(int size, int (*get)(const CubeState&), void (*set)(CubeState&, int),
+                           std::vector<uint16_t>& classOf, std::vector<uint8_t>& symmetryOf,
+                           std::vector<uint32_t>& representatives)
+{
+    const uint16_t unassigned = 0xFFFF;
+    classOf.assign(size, unassigned);
+    symmetryOf.assign(size, 0);
+    representatives.clear();
+    for(int i = 0; i < size; ++i)
+    {
+        if(classOf[i] != unassigned)
+        {
+            continue;
+        }
+
+        // The first value reached is the lowest of its class; give every conjugate its class
+        uint16_t index = (uint16_t)representatives.size();
+        representatives.push_back(i);
+        CubeState state;
+        set(state, i);
+        for(int s = 0; s < N_UD_SYMMETRIES; ++s)
+        {
+            int value = get(conjugate(state, s));
+            if(classOf[value] == unassigned)
+            {
+                classOf[value] = index;
+                symmetryOf[value] = (uint8_t)inverse(s);
+            }
+        }
+    }
+    return (int)representatives.size();
+}
@@ -0,0 +1,270 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/TableFile.hpp"
+
+namespace {
+
+const char MAGIC[8] = {'C', 'U', 'B', '3', 'R', 'T', 'B', 'L'};
+const uint32_t VERSION = 1;
+const uint64_t ALIGNMENT = 4096; // Tables start on a page boundary
+const int NAME_LENGTH = 32;
+const uint32_t MAX_TABLES = 64;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t tableCount;
+    uint64_t fileSize;
+    uint64_t directoryChecksum;
+};
+
+struct DirectoryEntry
+{
+    char name[NAME_LENGTH];
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+    uint64_t reserved;
+};
+
+uint64_t align(uint64_t offset)
+{
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+} // namespace
+
+TableFile::TableFile() :
+data{nullptr},
+size{0},
+valid{false},
+corrupt{false}
+{
+}
+
+TableFile::~TableFile()
+{
+    if(verifier.joinable())
+    {
+        verifier.join();
+    }
+    if(data != nullptr)
+    {
+        munmap((void*)data, size);
+    }
+}
+
+bool TableFile::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(Header))
+    {
+        close(fd);
+        return false;
+    }
+
+    // Map without populating: pages are read in as the solver first touches them
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        return false;
+    }
+    data = (const uint8_t*)mapping;
+    size = info.st_size;
+    this->path = path;
+
+    const Header* header = (const Header*)data;
+    uint64_t directorySize = header->tableCount * sizeof(DirectoryEntry);
+    bool ok = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              header->version == VERSION &&
+              header->fileSize == size &&
+              header->tableCount <= MAX_TABLES &&
+              sizeof(Header) + directorySize <= size &&
+              checksum(data + sizeof(Header), directorySize) == header->directoryChecksum;
+
+    const DirectoryEntry* directory = (const DirectoryEntry*)(data + sizeof(Header));
+    for(uint32_t i = 0; ok && i < header->tableCount; ++i)
+    {
+        ok = directory[i].offset % ALIGNMENT == 0 &&
+             directory[i].offset <= size && directory[i].size <= size - directory[i].offset;
+    }
+
+    if(!ok)
+    {
+        std::cerr << "Ignoring invalid table file " << path << '\n';
+        munmap(mapping, size);
+        data = nullptr;
+        size = 0;
+        return false;
+    }
+
+    // Start reading the whole file in asynchronously while the tables are already usable
+    madvise(mapping, size, MADV_WILLNEED);
+    return true;
+}
+
+const void* TableFile::getTable(const std::string& name, uint64_t tableSize) const
+{
+    if(data == nullptr)
+    {
+        return nullptr;
+    }
+    const Header* header = (const Header*)data;
+    const DirectoryEntry* directory = (const DirectoryEntry*)(data + sizeof(Header));
+    for(uint32_t i = 0; i < header->tableCount; ++i)
+    {
+        if(strncmp(directory[i].name, name.c_str(), NAME_LENGTH) == 0)
+        {
+            return directory[i].size == tableSize ? data + directory[i].offset : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void TableFile::verifyInBackground()
+{
+    if(data != nullptr && !verifier.joinable())
+    {
+        verifier = std::thread(&TableFile::verify, this);
+    }
+}
+
+bool TableFile::waitForVerification()
+{
+    if(verifier.joinable())
+    {
+        verifier.join();
+    }
+    return valid;
+}
+
+bool TableFile::isCorrupt() const
+{
+    return corrupt;
+}
+
+void TableFile::verify()
+{
+    const Header* header = (const Header*)data;
+    const DirectoryEntry* directory = (const DirectoryEntry*)(data + sizeof(Header));
+    bool ok = true;
+    for(uint32_t i = 0; ok && i < header->tableCount; ++i)
+    {
+        ok = checksum(data + directory[i].offset, directory[i].size) == directory[i].checksum;
+    }
+
+    valid = ok;
+    corrupt = !ok;
+    if(!ok)
+    {
+        // The mapping stays valid after the unlink, but the solvers no longer trust it; the next
+        // run builds a new file
+        std::cerr << "Error: table file " << path << " is corrupt and has been removed; solves will fail "
+                  << "until the program is restarted\n";
+        unlink(path.c_str());
+    }
+}
+
+bool TableFile::write(const std::string& path, const std::vector<Entry>& tables)
+{
+    size_t slash = path.find_last_of('/');
+    if(slash != std::string::npos)
+    {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+
+    std::vector<DirectoryEntry> directory(tables.size());
+    uint64_t offset = align(sizeof(Header) + tables.size() * sizeof(DirectoryEntry));
+    for(size_t i = 0; i < tables.size(); ++i)
+    {
+        memset(&directory[i], 0, sizeof(DirectoryEntry));
+        strncpy(directory[i].name, tables[i].name.c_str(), NAME_LENGTH - 1);
+        directory[i].offset = offset;
+        directory[i].size = tables[i].size;
+        directory[i].checksum = checksum((const uint8_t*)tables[i].data, tables[i].size);
+        offset = align(offset + tables[i].size);
+    }
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.tableCount = (uint32_t)tables.size();
+    header.fileSize = offset;
+    header.directoryChecksum = checksum((const uint8_t*)directory.data(), directory.size() * sizeof(DirectoryEntry));
+
+    std::string temporary = path + '.' + std::to_string(getpid());
+    std::ofstream file(temporary, std::ios::binary);
+    file.write((const char*)&header, sizeof(Header));
+    file.write((const char*)directory.data(), directory.size() * sizeof(DirectoryEntry));
+    for(size_t i = 0; i < tables.size(); ++i)
+    {
+        file.seekp(directory[i].offset);
+        file.write((const char*)tables[i].data, tables[i].size);
+    }
+    // Pad the last table out to the recorded file size
+    file.seekp(header.fileSize - 1);
+    file.put(0);
+    file.close();
+
+    if(!file || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "Error: could not write table file " << path << '\n';
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+uint64_t TableFile::checksum(const uint8_t* bytes, uint64_t count)
+{
+    // Word-at-a-time multiply-rotate hash; fast enough to check hundreds of megabytes
+    const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    uint64_t hash = count * prime1;
+    uint64_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash ^= word * prime2;
+        hash = ((hash << 31) | (hash >> 33)) * prime1;
+    }
+    for(; i < count; ++i)
+    {
+        hash ^= bytes[i] * prime2;
+        hash = ((hash << 31) | (hash >> 33)) * prime1;
+    }
+    return hash ^ (hash >> 29);
+}
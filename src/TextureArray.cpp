@@ -0,0 +1,95 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <SDL2/SDL_image.h>
+#include "../include/TextureArray.hpp"
+
+TextureArray::TextureArray() :
+texture{0}
+{}
+
+TextureArray::~TextureArray() {}
+
+void TextureArray::load(const std::vector<std::string>& paths)
+{
+    layers.clear();
+    for(const std::string& path : paths)
+    {
+        if(std::find(layers.begin(), layers.end(), path) == layers.end())
+        {
+            layers.push_back(path);
+        }
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    int width = 0;
+    int height = 0;
+    for(unsigned int i = 0; i < layers.size(); ++i)
+    {
+        SDL_Surface* image = IMG_Load(layers[i].c_str());
+        if(image == NULL)
+        {
+            std::cout << "Could not load image! SDL_image Error: " << layers[i] << ' ' << IMG_GetError() << '\n';
+            exit(1);
+        }
+        // The layers share one format, whatever each file was saved as
+        SDL_Surface* rgba = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(image);
+        if(rgba == NULL)
+        {
+            std::cout << "Could not convert image! SDL Error: " << layers[i] << ' ' << SDL_GetError() << '\n';
+            exit(1);
+        }
+
+        if(i == 0)
+        {
+            width = rgba->w;
+            height = rgba->h;
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers.size(),
+                         0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        }
+        else if(rgba->w != width || rgba->h != height)
+        {
+            std::cout << "Texture " << layers[i] << " is " << rgba->w << 'x' << rgba->h
+                      << ", not " << width << 'x' << height << " like the others.\n";
+            exit(1);
+        }
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba->pixels);
+        SDL_FreeSurface(rgba);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+GLfloat TextureArray::getLayer(const std::string& path) const
+{
+    std::vector<std::string>::const_iterator layer = std::find(layers.begin(), layers.end(), path);
+    return layer == layers.end() ? -1.0f : (GLfloat)(layer - layers.begin());
+}
+
+void TextureArray::bind(GLenum unit) const
+{
+    glActiveTexture(unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+}
@@ -0,0 +1,571 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include "../include/TwoPhaseSolver.hpp"
+#include "../include/Coordinates.hpp"
+#include "../include/PatternDatabase.hpp"
+#include "../include/Symmetry.hpp"
+#include "../include/TableFile.hpp"
+
+namespace {
+
+const int N_MOVES = CubeState::N_MOVES;
+const int N_PHASE2_MOVES = 10;
+const int N_FLIP_SLICE_CLASSES = 64430; // Flip-slice values up to the U-D symmetries
+const uint64_t N_PHASE1_ENTRIES = (uint64_t)N_FLIP_SLICE_CLASSES * Coordinates::N_TWIST; // Class x twist
+const int N_AXES = 3;
+const int N_STARTS = 2 * N_AXES;  // Each axis, for the state and its inverse
+const int AXIS_SYMMETRY = 16;     // The 120 degree turn about the URF-DBL diagonal
+const uint64_t CANCEL_CHECK_NODES = 1 << 12; // Phase 1 nodes between checks of the cancel flag
+const char* TABLE_FILE = "resources/tables/twophase.tbl";
+
+// The moves of the phase 2 subgroup: U, U2, U', D, D2, D', R2, F2, L2, B2
+const int PHASE2_MOVES[N_PHASE2_MOVES] = {0, 1, 2, 9, 10, 11, 4, 7, 13, 16};
+
+struct Tables
+{
+    const uint16_t* twistMove;       // [twist][move]
+    const uint16_t* flipMove;        // [flip][move]
+    const uint16_t* sliceSortedMove; // [slice sorted][move]
+    const uint16_t* cornerMove;      // [corner permutation][move]
+    const uint16_t* edgeMove;        // [U/D edge permutation][move], phase 2 moves only
+
+    const int8_t* twistSlicePrune;   // [twist][slice]
+    const int8_t* cornerSlicePrune;  // [corner permutation][slice permutation]
+    const int8_t* edgeSlicePrune;    // [U/D edge permutation][slice permutation]
+
+    // Exact phase 1 distances, 4-bit, one entry per class of flip-slice values with the twist
+    const uint8_t* phase1Prune;              // [flip-slice class][twist conjugated to the class]
+    const uint16_t* flipSliceClass;          // Class of each flip-slice value
+    const uint8_t* flipSliceSymmetry;        // Symmetry taking each flip-slice value to its representative
+    const uint32_t* flipSliceRepresentative; // Representative flip-slice value of each class
+    const uint16_t* twistConjugate;          // [twist][symmetry], the twist conjugated by each U-D symmetry
+
+    bool phase2Move[N_MOVES];
+};
+
+// Backs the tables when they are built rather than mapped from the table file
+struct Storage
+{
+    std::vector<uint16_t> twistMove;
+    std::vector<uint16_t> flipMove;
+    std::vector<uint16_t> sliceSortedMove;
+    std::vector<uint16_t> cornerMove;
+    std::vector<uint16_t> edgeMove;
+
+    std::vector<int8_t> twistSlicePrune;
+    std::vector<int8_t> cornerSlicePrune;
+    std::vector<int8_t> edgeSlicePrune;
+
+    std::vector<uint8_t> phase1Prune;
+    std::vector<uint16_t> flipSliceClass;
+    std::vector<uint8_t> flipSliceSymmetry;
+    std::vector<uint32_t> flipSliceRepresentative;
+    std::vector<uint16_t> twistConjugate;
+};
+
+Tables tables;
+Storage storage;
+TableFile file;
+
+/**
+ * Breadth-first fill of a pruning table over the product of two coordinates, each given by a
+ * move table. The second coordinate's table is indexed by value * step and divided by step, so
+ * the slice coordinate can be read from the slice sorted table.
+ */
+void buildPruneTable(std::vector<int8_t>& table, const std::vector<uint16_t>& first, int firstSize,
+                     const std::vector<uint16_t>& second, int secondSize, int step,
+                     const int* moves, int moveCount)
+{
+    int size = firstSize * secondSize;
+    table.assign(size, -1);
+    table[0] = 0;
+    int filled = 1;
+    int added = 1;
+    for(int depth = 0; filled < size && added > 0; ++depth)
+    {
+        added = 0;
+        for(int i = 0; i < size; ++i)
+        {
+            if(table[i] != depth)
+            {
+                continue;
+            }
+            int a = i / secondSize;
+            int b = i % secondSize;
+            for(int k = 0; k < moveCount; ++k)
+            {
+                int m = moves[k];
+                int next = first[a * N_MOVES + m] * secondSize + second[b * step * N_MOVES + m] / step;
+                if(table[next] < 0)
+                {
+                    table[next] = (int8_t)(depth + 1);
+                    ++filled;
+                    ++added;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Phase 1 table index of a flip-slice value and twist. The state is conjugated by the symmetry
+ * that takes its flip-slice value to the representative of its class; the twist can be
+ * conjugated on its own because the U-D symmetries twist every corner alike.
+ */
+inline uint64_t phase1Index(int flipSlice, int twist)
+{
+    int symmetry = tables.flipSliceSymmetry[flipSlice];
+    return (uint64_t)tables.flipSliceClass[flipSlice] * Coordinates::N_TWIST
+         + tables.twistConjugate[twist * Symmetry::N_UD_SYMMETRIES + symmetry];
+}
+
+/**
+ * Fill the phase 1 table from the move tables, which must already be built.
+ */
+void buildPhase1Table()
+{
+    Symmetry::buildClasses(Coordinates::N_FLIP_SLICE, Coordinates::getFlipSlice, Coordinates::setFlipSlice,
+                           storage.flipSliceClass, storage.flipSliceSymmetry, storage.flipSliceRepresentative);
+    Symmetry::buildConjugationTable(storage.twistConjugate, Coordinates::N_TWIST, Coordinates::getTwist,
+                                    Coordinates::setTwist);
+    tables.flipSliceClass = storage.flipSliceClass.data();
+    tables.flipSliceSymmetry = storage.flipSliceSymmetry.data();
+    tables.flipSliceRepresentative = storage.flipSliceRepresentative.data();
+    tables.twistConjugate = storage.twistConjugate.data();
+
+    // Symmetries that leave the representative of each class unchanged. A state whose flip-slice
+    // value has such a symmetry shares its class with the conjugates of its twist, so every move
+    // leads to all of their entries
+    std::vector<uint16_t> stabiliser(N_FLIP_SLICE_CLASSES, 0);
+    for(int c = 0; c < N_FLIP_SLICE_CLASSES; ++c)
+    {
+        CubeState state;
+        Coordinates::setFlipSlice(state, tables.flipSliceRepresentative[c]);
+        for(int s = 0; s < Symmetry::N_UD_SYMMETRIES; ++s)
+        {
+            if(Coordinates::getFlipSlice(Symmetry::conjugate(state, s)) == (int)tables.flipSliceRepresentative[c])
+            {
+                stabiliser[c] |= 1 << s;
+            }
+        }
+    }
+
+    // An entry stands for the representative flip-slice value with its twist
+    PatternDatabase::build(storage.phase1Prune, N_PHASE1_ENTRIES, 0, [&](uint64_t index, uint64_t* next) -> int
+    {
+        int flipSlice = (int)tables.flipSliceRepresentative[index / Coordinates::N_TWIST];
+        int sliceSorted = flipSlice / Coordinates::N_FLIP * Coordinates::N_SLICE_PERM;
+        int flip = flipSlice % Coordinates::N_FLIP;
+        int twist = (int)(index % Coordinates::N_TWIST);
+        int count = 0;
+        for(int m = 0; m < N_MOVES; ++m)
+        {
+            int movedFlipSlice = storage.sliceSortedMove[sliceSorted * N_MOVES + m] / Coordinates::N_SLICE_PERM * Coordinates::N_FLIP
+                               + storage.flipMove[flip * N_MOVES + m];
+            uint64_t moved = phase1Index(movedFlipSlice, storage.twistMove[twist * N_MOVES + m]);
+            uint64_t base = moved - moved % Coordinates::N_TWIST;
+            int movedTwist = (int)(moved % Coordinates::N_TWIST);
+            int symmetries = stabiliser[moved / Coordinates::N_TWIST];
+            for(int s = 0; s < Symmetry::N_UD_SYMMETRIES; ++s)
+            {
+                if(symmetries >> s & 1)
+                {
+                    next[count++] = base + tables.twistConjugate[movedTwist * Symmetry::N_UD_SYMMETRIES + s];
+                }
+            }
+        }
+        return count;
+    });
+    tables.phase1Prune = storage.phase1Prune.data();
+}
+
+template <typename T>
+bool mapTable(const char* name, const T*& table, int entries)
+{
+    table = (const T*)file.getTable(name, entries * sizeof(T));
+    return table != nullptr;
+}
+
+template <typename T>
+TableFile::Entry fileEntry(const char* name, const std::vector<T>& table)
+{
+    return {name, table.data(), table.size() * sizeof(T)};
+}
+
+/**
+ * Point the tables at the table file, if it exists and holds every table at its expected size.
+ */
+bool mapTables()
+{
+    return file.open(TABLE_FILE) &&
+           mapTable("twistMove", tables.twistMove, Coordinates::N_TWIST * N_MOVES) &&
+           mapTable("flipMove", tables.flipMove, Coordinates::N_FLIP * N_MOVES) &&
+           mapTable("sliceSortedMove", tables.sliceSortedMove, Coordinates::N_SLICE_SORTED * N_MOVES) &&
+           mapTable("cornerMove", tables.cornerMove, Coordinates::N_CORNER_PERM * N_MOVES) &&
+           mapTable("edgeMove", tables.edgeMove, Coordinates::N_UD_EDGE_PERM * N_MOVES) &&
+           mapTable("twistSlicePrune", tables.twistSlicePrune, Coordinates::N_TWIST * Coordinates::N_SLICE) &&
+           mapTable("cornerSlicePrune", tables.cornerSlicePrune, Coordinates::N_CORNER_PERM * Coordinates::N_SLICE_PERM) &&
+           mapTable("edgeSlicePrune", tables.edgeSlicePrune, Coordinates::N_UD_EDGE_PERM * Coordinates::N_SLICE_PERM) &&
+           mapTable("phase1Prune", tables.phase1Prune, (int)((N_PHASE1_ENTRIES + 1) / 2)) &&
+           mapTable("flipSliceClass", tables.flipSliceClass, Coordinates::N_FLIP_SLICE) &&
+           mapTable("flipSliceSymmetry", tables.flipSliceSymmetry, Coordinates::N_FLIP_SLICE) &&
+           mapTable("flipSliceRepresentative", tables.flipSliceRepresentative, N_FLIP_SLICE_CLASSES) &&
+           mapTable("twistConjugate", tables.twistConjugate, Coordinates::N_TWIST * Symmetry::N_UD_SYMMETRIES);
+}
+
+void buildTables()
+{
+    int allMoves[N_MOVES];
+    for(int m = 0; m < N_MOVES; ++m)
+    {
+        allMoves[m] = m;
+    }
+
+    Coordinates::buildMoveTable(storage.twistMove, Coordinates::N_TWIST, Coordinates::getTwist,
+                                Coordinates::setTwist, allMoves, N_MOVES);
+    Coordinates::buildMoveTable(storage.flipMove, Coordinates::N_FLIP, Coordinates::getFlip,
+                                Coordinates::setFlip, allMoves, N_MOVES);
+    Coordinates::buildMoveTable(storage.sliceSortedMove, Coordinates::N_SLICE_SORTED, Coordinates::getSliceSorted,
+                                Coordinates::setSliceSorted, allMoves, N_MOVES);
+    Coordinates::buildMoveTable(storage.cornerMove, Coordinates::N_CORNER_PERM, Coordinates::getCornerPermutation,
+                                Coordinates::setCornerPermutation, allMoves, N_MOVES);
+    Coordinates::buildMoveTable(storage.edgeMove, Coordinates::N_UD_EDGE_PERM, Coordinates::getUDEdgePermutation,
+                                Coordinates::setUDEdgePermutation, PHASE2_MOVES, N_PHASE2_MOVES);
+
+    buildPruneTable(storage.twistSlicePrune, storage.twistMove, Coordinates::N_TWIST,
+                    storage.sliceSortedMove, Coordinates::N_SLICE, Coordinates::N_SLICE_PERM,
+                    allMoves, N_MOVES);
+    buildPruneTable(storage.cornerSlicePrune, storage.cornerMove, Coordinates::N_CORNER_PERM,
+                    storage.sliceSortedMove, Coordinates::N_SLICE_PERM, 1,
+                    PHASE2_MOVES, N_PHASE2_MOVES);
+    buildPruneTable(storage.edgeSlicePrune, storage.edgeMove, Coordinates::N_UD_EDGE_PERM,
+                    storage.sliceSortedMove, Coordinates::N_SLICE_PERM, 1,
+                    PHASE2_MOVES, N_PHASE2_MOVES);
+
+    tables.twistMove = storage.twistMove.data();
+    tables.flipMove = storage.flipMove.data();
+    tables.sliceSortedMove = storage.sliceSortedMove.data();
+    tables.cornerMove = storage.cornerMove.data();
+    tables.edgeMove = storage.edgeMove.data();
+    tables.twistSlicePrune = storage.twistSlicePrune.data();
+    tables.cornerSlicePrune = storage.cornerSlicePrune.data();
+    tables.edgeSlicePrune = storage.edgeSlicePrune.data();
+
+    buildPhase1Table();
+
+    TableFile::write(TABLE_FILE, {fileEntry("twistMove", storage.twistMove),
+                                  fileEntry("flipMove", storage.flipMove),
+                                  fileEntry("sliceSortedMove", storage.sliceSortedMove),
+                                  fileEntry("cornerMove", storage.cornerMove),
+                                  fileEntry("edgeMove", storage.edgeMove),
+                                  fileEntry("twistSlicePrune", storage.twistSlicePrune),
+                                  fileEntry("cornerSlicePrune", storage.cornerSlicePrune),
+                                  fileEntry("edgeSlicePrune", storage.edgeSlicePrune),
+                                  fileEntry("phase1Prune", storage.phase1Prune),
+                                  fileEntry("flipSliceClass", storage.flipSliceClass),
+                                  fileEntry("flipSliceSymmetry", storage.flipSliceSymmetry),
+                                  fileEntry("flipSliceRepresentative", storage.flipSliceRepresentative),
+                                  fileEntry("twistConjugate", storage.twistConjugate)});
+}
+
+} // namespace
+
+TwoPhaseSolver::TwoPhaseSolver() :
+cache{nullptr},
+cancelled{nullptr},
+nodes{0},
+stopped{false}
+{
+    initTables();
+}
+
+TwoPhaseSolver::~TwoPhaseSolver() {}
+
+uint64_t TwoPhaseSolver::getNodeCount() const
+{
+    return nodes;
+}
+
+double TwoPhaseSolver::initTables()
+{
+    static std::once_flag built;
+    double seconds = 0.0;
+    std::call_once(built, [&seconds]()
+    {
+        auto begin = std::chrono::steady_clock::now();
+
+        for(int m = 0; m < N_MOVES; ++m)
+        {
+            tables.phase2Move[m] = false;
+        }
+        for(int m : PHASE2_MOVES)
+        {
+            tables.phase2Move[m] = true;
+        }
+
+        if(mapTables())
+        {
+            // The tables are paged in as the search touches them
+            file.verifyInBackground();
+        }
+        else
+        {
+            buildTables();
+        }
+
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    });
+    return seconds;
+}
+
+bool TwoPhaseSolver::solve(const CubeState& state, std::vector<int>& solution, int maxLength)
+{
+    solution.clear();
+    nodes = 0;
+    stopped = false;
+    if(state.isSolved())
+    {
+        return true;
+    }
+    if(cache != nullptr && cache->lookup(SolutionCache::TWO_PHASE, state, maxLength, solution))
+    {
+        return true;
+    }
+    if(file.isCorrupt())
+    {
+        return false;
+    }
+    this->maxLength = std::min(maxLength, MAX_DEPTH - 1);
+
+    // A solution of the inverse state, inverted, also solves the state, and so do the moves of
+    // a solution of the state turned about the URF-DBL diagonal, turned back. Some of these six
+    // starts need far longer phase 1 searches than others, so deepen them all in turn
+    CubeState starts[N_STARTS];
+    uint64_t startSymmetries[N_STARTS];
+    for(int i = 0; i < N_STARTS; ++i)
+    {
+        starts[i] = Symmetry::conjugate(i < N_AXES ? state : state.inverse(), AXIS_SYMMETRY * (i % N_AXES));
+        // Only the U-D symmetries map the phase 1 subgroup onto itself
+        startSymmetries[i] = Symmetry::getSymmetries(starts[i]) & ((1ULL << Symmetry::N_UD_SYMMETRIES) - 1);
+    }
+
+    for(int depth = 0; depth <= this->maxLength && !stopped; ++depth)
+    {
+        if(progress)
+        {
+            progress(depth, nodes);
+        }
+        for(int i = 0; i < N_STARTS; ++i)
+        {
+            start = starts[i];
+            symmetries = startSymmetries[i];
+            twist[0] = Coordinates::getTwist(start);
+            flip[0]  = Coordinates::getFlip(start);
+            slice[0] = Coordinates::getSliceSorted(start);
+            cornerPerm[0] = Coordinates::getCornerPermutation(start);
+            moves[0] = -1;
+            if(!searchPhase1(0, depth))
+            {
+                continue;
+            }
+
+            int turnBack = Symmetry::inverse(AXIS_SYMMETRY * (i % N_AXES));
+            for(int length = 0; length < MAX_DEPTH && moves[length] >= 0; ++length)
+            {
+                solution.push_back(Symmetry::conjugateMove(moves[length], turnBack));
+            }
+            if(i >= N_AXES)
+            {
+                std::reverse(solution.begin(), solution.end());
+                for(int& move : solution)
+                {
+                    move = CubeState::inverseMove(move);
+                }
+            }
+            // The tables may have failed verification while the search used them
+            if(file.isCorrupt())
+            {
+                solution.clear();
+                return false;
+            }
+            if(cache != nullptr)
+            {
+                cache->insert(SolutionCache::TWO_PHASE, state, solution);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void TwoPhaseSolver::setCache(SolutionCache* cache)
+{
+    this->cache = cache;
+}
+
+void TwoPhaseSolver::setProgress(Progress progress)
+{
+    this->progress = progress;
+}
+
+void TwoPhaseSolver::setCancelFlag(const std::atomic<bool>* cancelled)
+{
+    this->cancelled = cancelled;
+}
+
+bool TwoPhaseSolver::searchPhase1(int depth, int togo)
+{
+    if((++nodes & (CANCEL_CHECK_NODES - 1)) == 0 && cancelled != nullptr &&
+       cancelled->load(std::memory_order_relaxed))
+    {
+        stopped = true;
+    }
+    if(stopped)
+    {
+        return false;
+    }
+
+    if(togo == 0)
+    {
+        // Children are only entered at distance 0, so only the root can be outside the subgroup
+        if(depth == 0 && (twist[0] != 0 || flip[0] != 0 || slice[0] >= Coordinates::N_SLICE_PERM))
+        {
+            return false;
+        }
+        // A phase 1 solution ending in a phase 2 move was already found one move shorter
+        if(depth > 0 && tables.phase2Move[moves[depth - 1]])
+        {
+            return false;
+        }
+        return startPhase2(depth);
+    }
+
+    uint32_t following = CubeState::followingMoves(depth > 0 ? moves[depth - 1] : -1);
+    for(int m = 0; m < N_MOVES; ++m)
+    {
+        if(!(following >> m & 1) || (depth == 0 && Symmetry::isDuplicateMove(m, symmetries)))
+        {
+            continue;
+        }
+
+        // Test the bounds one at a time so most children are rejected after one lookup
+        int t = tables.twistMove[twist[depth] * N_MOVES + m];
+        int s = tables.sliceSortedMove[slice[depth] * N_MOVES + m];
+        int sliceCoord = s / Coordinates::N_SLICE_PERM;
+        if(tables.twistSlicePrune[t * Coordinates::N_SLICE + sliceCoord] >= togo)
+        {
+            continue;
+        }
+        int f = tables.flipMove[flip[depth] * N_MOVES + m];
+        // The exact distance, from the large table, only for the children the twist-slice bound lets through
+        if(PatternDatabase::lookup(tables.phase1Prune, phase1Index(sliceCoord * Coordinates::N_FLIP + f, t)) >= togo)
+        {
+            continue;
+        }
+
+        twist[depth + 1] = t;
+        flip[depth + 1]  = f;
+        slice[depth + 1] = s;
+        moves[depth] = m;
+        moves[depth + 1] = -1;
+        if(searchPhase1(depth + 1, togo - 1))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TwoPhaseSolver::startPhase2(int depth)
+{
+    // The corner permutation is cheap to follow through phase 1 with its move table and often
+    // rules the phase 1 solution out before the edges need to be computed
+    int corners = cornerPerm[0];
+    for(int i = 0; i < depth; ++i)
+    {
+        corners = tables.cornerMove[corners * N_MOVES + moves[i]];
+    }
+    int distance = tables.cornerSlicePrune[corners * Coordinates::N_SLICE_PERM + slice[depth]];
+    if(distance > maxLength - depth)
+    {
+        return false;
+    }
+
+    CubeState state = start;
+    for(int i = 0; i < depth; ++i)
+    {
+        state.apply(moves[i]);
+    }
+    cornerPerm[depth] = corners;
+    edgePerm[depth]   = Coordinates::getUDEdgePermutation(state);
+    slicePerm[depth]  = slice[depth];
+
+    distance = std::max(distance, (int)tables.edgeSlicePrune[edgePerm[depth] * Coordinates::N_SLICE_PERM + slicePerm[depth]]);
+    for(int togo = distance; depth + togo <= maxLength; ++togo)
+    {
+        if(searchPhase2(depth, togo))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TwoPhaseSolver::searchPhase2(int depth, int togo)
+{
+    if(togo == 0)
+    {
+        moves[depth] = -1;
+        return cornerPerm[depth] == 0 && edgePerm[depth] == 0 && slicePerm[depth] == 0;
+    }
+
+    uint32_t following = CubeState::followingMoves(depth > 0 ? moves[depth - 1] : -1);
+    for(int m : PHASE2_MOVES)
+    {
+        if(!(following >> m & 1))
+        {
+            continue;
+        }
+
+        int c = tables.cornerMove[cornerPerm[depth] * N_MOVES + m];
+        int e = tables.edgeMove[edgePerm[depth] * N_MOVES + m];
+        int s = tables.sliceSortedMove[slicePerm[depth] * N_MOVES + m];
+        int distance = std::max(tables.cornerSlicePrune[c * Coordinates::N_SLICE_PERM + s],
+                                tables.edgeSlicePrune[e * Coordinates::N_SLICE_PERM + s]);
+        if(distance > togo - 1)
+        {
+            continue;
+        }
+
+        cornerPerm[depth + 1] = c;
+        edgePerm[depth + 1]   = e;
+        slicePerm[depth + 1]  = s;
+        moves[depth] = m;
+        if(searchPhase2(depth + 1, togo - 1))
+        {
+            return true;
+        }
+    }
+    return false;
+}
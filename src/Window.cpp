@@ -18,16 +18,21 @@
 */
 
 #include <iostream>
+#include <sstream>
 #include <SDL2/SDL_image.h>
+#include "../include/Facelets.hpp"
 #include "../include/Window.hpp"
 
-Window::Window(int width, int height) :
+Window::Window(int width, int height, int cubeSize) :
 width{width},
 height{height},
 running{true},
 inFocus{true},
 mouseSensitivity{0.005},
-scene{width, height}
+scene{width, height, cubeSize},
+solveRequest{0},
+showingTransformUpdates{false},
+shownTransformUpdates{0}
 {
     initWindow();
     initGL();
@@ -41,6 +46,11 @@ void Window::renderScene()
 {
     scene.render();
     SDL_GL_SwapWindow(window);
+
+    if(showingTransformUpdates && scene.getFrameTransformUpdates() != shownTransformUpdates)
+    {
+        showTransformUpdates();
+    }
 }
 
 void Window::initWindow()
@@ -152,6 +162,7 @@ void Window::handleEvents()
             break;
         }
     }
+    handleSolverMessages();
     scene.handleCamera();
 }
 
@@ -185,76 +196,108 @@ void Window::handleKeyPressed(SDL_Keycode value)
         scene.getCamera().setSpeedX(-scene.getCameraSpeed());
         break;
     }
+    case SDLK_SPACE:
+    {
+        startSolve();
+        break;
+    }
+    case SDLK_c:
+    {
+        if(keystates[SDL_SCANCODE_LCTRL])
+        {
+            copyState();
+        }
+        break;
+    }
+    case SDLK_v:
+    {
+        if(keystates[SDL_SCANCODE_LCTRL])
+        {
+            pasteState();
+        }
+        break;
+    }
+    case SDLK_t:
+    {
+        toggleTransformUpdates();
+        break;
+    }
     case SDLK_k:
     {
+        cancelSolve();
         if(keystates[SDL_SCANCODE_LSHIFT])
 
         {
-            scene.getCube().rotateFront(90.0f, false);
+            scene.getCube().rotateFront(false);
         }
         else
         {
-            scene.getCube().rotateFront(-90.0f, true);
+            scene.getCube().rotateFront(true);
         }
         break;
     }
     case SDLK_o:
     {
+        cancelSolve();
         if(keystates[SDL_SCANCODE_LSHIFT])
         {
-            scene.getCube().rotateBack(-90.0f, false);
+            scene.getCube().rotateBack(false);
         }
         else
         {
-            scene.getCube().rotateBack(90.0f, true);
+            scene.getCube().rotateBack(true);
         }
         break;
     }
     case SDLK_j:
     {
+        cancelSolve();
         if(keystates[SDL_SCANCODE_LSHIFT])
         {
-            scene.getCube().rotateLeft(-90.0f, false);
+            scene.getCube().rotateLeft(false);
         }
         else
         {
-            scene.getCube().rotateLeft(90.0f, true);
+            scene.getCube().rotateLeft(true);
         }
         break;
     }
     case SDLK_l:
     {
+        cancelSolve();
         if(keystates[SDL_SCANCODE_LSHIFT])
         {
-            scene.getCube().rotateRight(90.0f, false);
+            scene.getCube().rotateRight(false);
         }
         else
         {
-            scene.getCube().rotateRight(-90.0f, true);
+            scene.getCube().rotateRight(true);
         }
         break;
     }
     case SDLK_i:
     {
+        cancelSolve();
         if(keystates[SDL_SCANCODE_LSHIFT])
         {
-            scene.getCube().rotateTop(90.0f, false);
+            scene.getCube().rotateTop(false);
         }
         else
         {
-            scene.getCube().rotateTop(-90.0f, true);
+            scene.getCube().rotateTop(true);
         }
         break;
     }
     case SDLK_m:
     {
+        cancelSolve();
         if(keystates[SDL_SCANCODE_LSHIFT])
         {
-            scene.getCube().rotateBottom(-90.0f, false);
+            scene.getCube().rotateBottom(false);
         }
         else
         {
-            scene.getCube().rotateBottom(90.0f, true);
+            scene.getCube().rotateBottom(true);
         }
         break;
     }
@@ -303,4 +346,107 @@ void Window::handleKeyReleased(SDL_Keycode value)
     default:
         break;
     }
-}
\ No newline at end of file
+}
+
+void Window::startSolve()
+{
+    if(scene.getCube().getSize() != 3)
+    {
+        return;
+    }
+    CubeState state = scene.getCube().getFinalState();
+    if(!state.isSolved())
+    {
+        solveRequest = solver.solve(state);
+        SDL_SetWindowTitle(window, "Cub3r - solving");
+    }
+}
+
+void Window::cancelSolve()
+{
+    if(solveRequest != 0)
+    {
+        solver.cancel();
+        solveRequest = 0;
+        SDL_SetWindowTitle(window, "Cub3r");
+    }
+}
+
+void Window::handleSolverMessages()
+{
+    SolverWorker::Message message;
+    while(solver.poll(message))
+    {
+        if(message.request != solveRequest)
+        {
+            continue; // About a solve since cancelled or replaced
+        }
+        std::ostringstream title;
+        title << "Cub3r - ";
+        switch(message.type)
+        {
+        case SolverWorker::Message::PROGRESS:
+            title << "searching depth " << message.depth << ", " << message.nodes << " nodes";
+            break;
+        case SolverWorker::Message::SOLVED:
+            title << "solved in " << message.depth << " moves, " << message.seconds << " s";
+            scene.getCube().play(message.getSolution());
+            solveRequest = 0;
+            break;
+        case SolverWorker::Message::FAILED:
+            title << "no solution found";
+            solveRequest = 0;
+            break;
+        }
+        SDL_SetWindowTitle(window, title.str().c_str());
+    }
+}
+
+void Window::toggleTransformUpdates()
+{
+    showingTransformUpdates = !showingTransformUpdates;
+    if(showingTransformUpdates)
+    {
+        showTransformUpdates();
+    }
+    else
+    {
+        SDL_SetWindowTitle(window, "Cub3r");
+    }
+}
+
+void Window::showTransformUpdates()
+{
+    shownTransformUpdates = scene.getFrameTransformUpdates();
+    std::ostringstream title;
+    title << "Cub3r - " << shownTransformUpdates << " matrices recomputed last frame";
+    SDL_SetWindowTitle(window, title.str().c_str());
+}
+
+void Window::copyState()
+{
+    if(scene.getCube().getSize() == 3)
+    {
+        SDL_SetClipboardText(Facelets::fromState(scene.getCube().getFinalState()).c_str());
+    }
+}
+
+void Window::pasteState()
+{
+    char* clipboard = SDL_GetClipboardText();
+    std::string text = clipboard != NULL ? clipboard : "";
+    SDL_free(clipboard);
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+    text = begin == std::string::npos ? "" : text.substr(begin, end - begin + 1);
+
+    // Screened before it reaches the cube or a solver
+    CubeState state;
+    if(!Facelets::toState(text, state) || !state.isSolvable() || !scene.getCube().setState(state))
+    {
+        SDL_SetWindowTitle(window, "Cub3r - not a solvable 3x3x3 facelet string");
+        return;
+    }
+    cancelSolve();
+    SDL_SetWindowTitle(window, "Cub3r");
+}
@@ -0,0 +1,136 @@
+/*
+  Copyright Michael Quested 2014.
+
+  This file is part of Cub3r.
+
+  Cub3r is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Cub3r is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Cub3r.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include "../include/WorkStealingPool.hpp"
+
+WorkStealingPool::WorkStealingPool(int threads) :
+batch{0},
+pending{0},
+quit{false}
+{
+    threads = std::max(threads, 1);
+    for(int i = 0; i < threads; ++i)
+    {
+        queues.emplace_back(new Queue());
+    }
+    for(int i = 0; i < threads; ++i)
+    {
+        this->threads.emplace_back(&WorkStealingPool::work, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(std::vector<Task>& tasks)
+{
+    if(tasks.empty())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    pending = tasks.size();
+    size_t count = queues.size();
+    for(size_t i = 0; i < count; ++i)
+    {
+        std::lock_guard<std::mutex> queueLock(queues[i]->mutex);
+        for(size_t k = i * tasks.size() / count; k < (i + 1) * tasks.size() / count; ++k)
+        {
+            queues[i]->tasks.push_back(std::move(tasks[k]));
+        }
+    }
+    ++batch;
+    wake.notify_all();
+    done.wait(lock, [this]() { return pending == 0; });
+}
+
+int WorkStealingPool::getThreadCount() const
+{
+    return (int)threads.size();
+}
+
+void WorkStealingPool::work(int worker)
+{
+    unsigned int seen = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen]() { return quit || batch != seen; });
+            if(quit)
+            {
+                return;
+            }
+            seen = batch;
+        }
+
+        Task task;
+        while(next(worker, task))
+        {
+            task(worker);
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--pending == 0)
+            {
+                done.notify_all();
+            }
+        }
+    }
+}
+
+bool WorkStealingPool::next(int worker, Task& task)
+{
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty())
+        {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Steal from the back of another queue, starting with the next worker along
+    size_t count = queues.size();
+    for(size_t i = 1; i < count; ++i)
+    {
+        Queue& victim = *queues[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}